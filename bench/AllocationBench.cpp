@@ -0,0 +1,108 @@
+#include "VectorFont.h"
+#include "Roboto_Regular.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <algorithm>
+
+/* Counts the heap allocations of VectorFont::Init and of the glyph extrusion.
+   An eager Init of Roboto made initBefore allocations while the geometry API
+   took its arguments by value, the bench fails if Init gets back there. The
+   extrusion runs once with the const reference signatures and once through
+   wrappers taking the arguments by value, the difference is the number of
+   argument copies the reference signatures avoid */
+
+static const size_t initBefore = 178100;
+
+static std::atomic< size_t > allocations( 0 );
+static std::atomic< size_t > allocatedBytes( 0 );
+
+void *operator new( size_t size )
+{
+    ++allocations;
+    allocatedBytes += size;
+    void *memory = malloc( size ? size : 1 );
+    if( !memory )
+        throw std::bad_alloc();
+    return memory;
+}
+
+void operator delete( void *memory ) noexcept
+{
+    free( memory );
+}
+
+void operator delete( void *memory, size_t ) noexcept
+{
+    free( memory );
+}
+
+struct Count
+{
+    size_t                                  allocations;
+    size_t                                  bytes;
+};
+
+template< class Call > Count counted( Call call )
+{
+    const size_t startAllocations = allocations;
+    const size_t startBytes = allocatedBytes;
+    call();
+    Count count;
+    count.allocations = allocations - startAllocations;
+    count.bytes = allocatedBytes - startBytes;
+    return count;
+}
+
+static Face growByValue( const Face polygon, float width )
+{
+    return FaceGeneators::grow( polygon, width );
+}
+
+static Triangles bevelExtrudeByValue( const Face polygon, const Faces holes, float height, float radius, int slices )
+{
+    return TriangleGeneators::bevelExtrude( polygon, holes, height, radius, slices, true, true );
+}
+
+static void report( const char *name, const Count &count )
+{
+    printf( "%-28s %10zu allocations %12zu bytes\n", name, count.allocations, count.bytes );
+}
+
+int main()
+{
+    VectorFont font;
+    const Count init = counted( [ & ]() {
+        font.Init( Roboto_Regular::font(), 0.1f, 0.5f, 0.12f, 1 );
+    } );
+    report( "VectorFont::Init", init );
+    printf( "%zu allocations fewer than before the reference signatures\n", initBefore - std::min( init.allocations, initBefore ));
+
+    std::vector< std::vector< std::pair< Face, std::vector< Face >>>> glyphPolys;
+    for( const auto &glyph : font.glyphs )
+        glyphPolys.push_back( font.groupContours( glyph.outlines ).grouped() );
+
+    const VectorFont::GlyphStyle &style = font.style;
+    size_t checksum = 0;
+    Count reference = counted( [ & ]() {
+        for( const auto &polys : glyphPolys ) {
+            for( const auto &poly : polys ) {
+                checksum += TriangleGeneators::bevelExtrude( poly.first, poly.second, style.depth, style.bevel, style.roundStep, true, true ).mVertices.size();
+                checksum += FaceGeneators::grow( poly.first, 0.05f ).size();
+            }
+        }
+    } );
+    Count byValue = counted( [ & ]() {
+        for( const auto &polys : glyphPolys ) {
+            for( const auto &poly : polys ) {
+                checksum -= bevelExtrudeByValue( poly.first, poly.second, style.depth, style.bevel, style.roundStep ).mVertices.size();
+                checksum -= growByValue( poly.first, 0.05f ).size();
+            }
+        }
+    } );
+    report( "extrusion, by reference", reference );
+    report( "extrusion, by value", byValue );
+    printf( "%zu glyphs, %zu argument copies avoided\n", glyphPolys.size(), byValue.allocations - reference.allocations );
+    return checksum || init.allocations >= initBefore || reference.allocations >= byValue.allocations;
+}
@@ -113,9 +113,7 @@ struct Plane : public std::vector<Vector2D>
     }
     Plane reversed() const {
         Plane back;
-        for( auto &point : *this ) {
-            back.insert( back.begin(), point );
-        }
+        back.assign( rbegin(), rend() );
         return back;
     }
 };
@@ -351,7 +349,8 @@ public:
                           "#include <map>\n"
                           "#include <utility>\n"
                           "namespace " + fontName + " {\n"
-                          "std::map< long, std::vector<std::vector<std::pair<double,double>>>> font = {\n";
+                          "inline const std::map< long, std::vector<std::vector<std::pair<double,double>>>> &font() {\n"
+                          "static const std::map< long, std::vector<std::vector<std::pair<double,double>>>> font = {\n";
         write( outFile, str.c_str(), str.size() );
 
         std::string chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZÖÜÓŐÚÉÁŰÍabcdefghijklmnopqrstuvwxyzöüópőúéáűí0123456789\\\"_-+/*?!%/=()&,.:$€<>[]{}°^~";
@@ -413,7 +412,7 @@ public:
             Print( outFile, (const char*)&unichar );
             charData.clear();
         }
-        str = "};\n};\n";
+        str = "};\nreturn font;\n}\n};\n";
         write( outFile, str.c_str(), str.size() );
         close( outFile );
     }
@@ -2,7 +2,8 @@
 #include <map>
 #include <utility>
 namespace Roboto_Regular {
-std::map< long, std::vector<std::vector<std::pair<double,double>>>> font = {
+inline const std::map< long, std::vector<std::vector<std::pair<double,double>>>> &font() {
+static const std::map< long, std::vector<std::vector<std::pair<double,double>>>> font = {
 {L'A',{{{ 1.11200, 0.00000 },{ 1.30900, 0.00000 },{ 0.75200, 1.45600 },{ 0.58400, 1.45600 },{ 0.02800, 0.00000 },{ 0.22600, 0.00000 },{ 0.36300, 0.38000 },{ 0.97300, 0.38000 }},
 {{ 0.42100, 0.53800 },{ 0.91600, 0.53800 },{ 0.66800, 1.21900 }}}},
 {L'B',{{{ 0.67400, 0.00000 },{ 0.78344, 0.00700 },{ 0.87975, 0.02800 },{ 0.96294, 0.06300 },{ 1.03300, 0.11200 },{ 1.08856, 0.17325 },{ 1.12825, 0.24500 },{ 1.15206, 0.32725 },{ 1.16000, 0.42000 },{ 1.15569, 0.48175 },{ 1.14275, 0.53900 },{ 1.12119, 0.59175 },{ 1.09100, 0.64000 },{ 1.05388, 0.68275 },{ 1.01050, 0.71800 },{ 0.96088, 0.74575 },{ 0.90500, 0.76600 },{ 0.95238, 0.78969 },{ 0.99450, 0.81775 },{ 1.03138, 0.85019 },{ 1.06300, 0.88700 },{ 1.08838, 0.92794 },{ 1.10650, 0.97175 },{ 1.11738, 1.01844 },{ 1.12100, 1.06800 },{ 1.11350, 1.15813 },{ 1.09100, 1.23650 },{ 1.05350, 1.30313 },{ 1.00100, 1.35800 },{ 0.93413, 1.40088 },{ 0.85250, 1.43150 },{ 0.75613, 1.44988 },{ 0.64500, 1.45600 },{ 0.16900, 1.45600 },{ 0.16900, 0.00000 }},
@@ -185,4 +186,6 @@ std::map< long, std::vector<std::vector<std::pair<double,double>>>> font = {
 {{ 0.38500, 1.08800 },{ 0.41094, 1.09019 },{ 0.43475, 1.09675 },{ 0.45644, 1.10769 },{ 0.47600, 1.12300 },{ 0.49219, 1.14231 },{ 0.50375, 1.16425 },{ 0.51069, 1.18881 },{ 0.51300, 1.21600 },{ 0.51069, 1.24369 },{ 0.50375, 1.26875 },{ 0.49219, 1.29119 },{ 0.47600, 1.31100 },{ 0.45644, 1.32763 },{ 0.43475, 1.33950 },{ 0.41094, 1.34663 },{ 0.38500, 1.34900 },{ 0.35856, 1.34650 },{ 0.33425, 1.33900 },{ 0.31206, 1.32650 },{ 0.29200, 1.30900 },{ 0.27581, 1.28856 },{ 0.26425, 1.26625 },{ 0.25731, 1.24206 },{ 0.25500, 1.21600 },{ 0.25731, 1.19006 },{ 0.26425, 1.16625 },{ 0.27581, 1.14456 },{ 0.29200, 1.12500 },{ 0.31206, 1.10881 },{ 0.33425, 1.09725 },{ 0.35856, 1.09031 }}}},
 {L'^',{{{ 0.61700, 0.72900 },{ 0.78800, 0.72900 },{ 0.49000, 1.45600 },{ 0.36300, 1.45600 },{ 0.06400, 0.72900 },{ 0.23600, 0.72900 },{ 0.42600, 1.21100 }}}},
 {L'~',{{{ 1.11000, 0.77600 },{ 1.10700, 0.73081 },{ 1.09800, 0.69025 },{ 1.08300, 0.65431 },{ 1.06200, 0.62300 },{ 1.03669, 0.59763 },{ 1.00775, 0.57950 },{ 0.97519, 0.56863 },{ 0.93900, 0.56500 },{ 0.91000, 0.56700 },{ 0.87650, 0.57638 },{ 0.84000, 0.59450 },{ 0.80050, 0.62138 },{ 0.75800, 0.65700 },{ 0.71513, 0.69444 },{ 0.67450, 0.72575 },{ 0.63613, 0.75094 },{ 0.60000, 0.77000 },{ 0.56463, 0.78400 },{ 0.52850, 0.79400 },{ 0.49163, 0.80000 },{ 0.45400, 0.80200 },{ 0.38744, 0.79556 },{ 0.32675, 0.77625 },{ 0.27194, 0.74406 },{ 0.22300, 0.69900 },{ 0.18275, 0.64394 },{ 0.15400, 0.58175 },{ 0.13675, 0.51244 },{ 0.13100, 0.43600 },{ 0.29200, 0.43800 },{ 0.29463, 0.48244 },{ 0.30250, 0.52175 },{ 0.31563, 0.55594 },{ 0.33400, 0.58500 },{ 0.35725, 0.60863 },{ 0.38500, 0.62550 },{ 0.41725, 0.63563 },{ 0.45400, 0.63900 },{ 0.47469, 0.63788 },{ 0.49475, 0.63450 },{ 0.51419, 0.62888 },{ 0.53300, 0.62100 },{ 0.55444, 0.60850 },{ 0.58175, 0.58900 },{ 0.61494, 0.56250 },{ 0.65400, 0.52900 },{ 0.69519, 0.49494 },{ 0.73375, 0.46675 },{ 0.76969, 0.44444 },{ 0.80300, 0.42800 },{ 0.83550, 0.41663 },{ 0.86900, 0.40850 },{ 0.90350, 0.40363 },{ 0.93900, 0.40200 },{ 1.00475, 0.40875 },{ 1.06500, 0.42900 },{ 1.11975, 0.46275 },{ 1.16900, 0.51000 },{ 1.21013, 0.56756 },{ 1.23950, 0.63125 },{ 1.25713, 0.70106 },{ 1.26300, 0.77700 }}}}};
+return font;
+}
 }
@@ -10,6 +10,11 @@
 #include <Faces.h>
 #include <Triangles.h>
 #include <VectorFont.h>
+#include <Bvh.h>
+#include <SdfAtlas.h>
+#include <EditableText.h>
+#include <GlyphCache.h>
+#include <TrueTypeFont.h>
 #include <memory>
 #include <thread>
 
@@ -17,12 +22,13 @@
 
 struct singleChar
 {
-    /* Constructor */                               singleChar( std::shared_ptr<VectorFont::Char3D> letter = nullptr );
+    /* Constructor */                               singleChar( const VectorFont::Char3D &letter = VectorFont::Char3D() );
     /* Copy constructor */                          singleChar( const singleChar &other );
     singleChar *                                    operator = ( const singleChar &other );
+    Matrix                                          placement( float difftime, float angle ) const;
 
     float                                           minx;
-    std::shared_ptr<VectorFont::Char3D>             letter;
+    VectorFont::Char3D                              letter;
     Vector3D                                        move_from;
     float                                           rotate_y;
     float                                           rotate_z;
@@ -40,8 +46,15 @@ struct Letters3D
 
     std::vector< singleChar >                       letters;
     float                                           start_time;
-
-    void                                            randomize();
+    SceneBVH                                        bvh;
+
+    void                                            randomize( size_t first = 0 );
+    void                                            retire( size_t count );
+    void                                            buildBVH( VectorFont &font );
+    void                                            extendBVH( VectorFont &font );
+    void                                            place( float difftime, float angle );
+    void                                            refresh( const VectorFont &font );
+    int                                             pick( const Ray &ray, RayHit &hit ) const;
 };
 
 /* Helper class for animate 3D texts */
@@ -100,8 +113,27 @@ public:
     virtual void                                    mousePress() override;
     virtual void                                    mouseRelease() override;
     virtual void                                    paint() override;
+    void                                            streamLines( float difftime, float top );
+    void                                            refreshGlyphs();
+    void                                            adaptDetail();
+    void                                            restyleFont( float depthStep, float bevelStep, int roundSteps );
+    void                                            paintHud( float ow );
 
     VectorFont                                      defaultFont;
+
+    /* A text streamed in a TrueType font may use thousands of glyphs, their
+       meshes are then kept under a budget here instead of by the font */
+
+    GlyphCache                                      mGlyphCache;
+
+    /* Once Init is done the TrueType font is decoded on the refiner of
+       defaultFont only. mTolerance is the detail last asked for */
+
+    TrueTypeFont                                    mTrueType;
+    std::vector< char32_t >                         mFontChars;
+    float                                           mTolerance;
+    string                                          mFontPath;
+    string                                          mBuildReport;
     Triangles                                       mCursor;
     float                                           xPos;
     float                                           yPos;
@@ -110,14 +142,43 @@ public:
     bool                                            mWire;
     bool                                            mTransp;
     bool                                            mPause;
+    bool                                            mHud;
     GLenum                                          format;
     GLuint                                          texId;
     float                                           diffClock;
     float                                           angle;
     Program                                         program;
     Program                                         minimalProgram;
+    Program                                         sdfProgram;
+    SdfAtlas                                        mAtlas;
+    GLuint                                          mAtlasTexture;
+
+    /* The status lines are extruded text patched line by line, the key help
+       is flat quads from the distance field atlas, made once */
+
+    EditableText                                    mHudText;
+    TexturedMesh                                    mHelp;
     Timer< chrono::milliseconds, chrono::steady_clock> clock;
     std::shared_ptr<Letters3D>                      mChars;
+    int                                             mPicked;
+
+    /* Streaming mode lays out lines just before they fly in, straight from
+       the mapped text file */
+
+    string                                          mText;
+    MappedFile                                      mTextFile;
+    bool                                            mStreaming;
+    VectorFont::LineCursor                          mLines;
+    size_t                                          mMaxLetters;
+
+    /* Glyphs refined when the letters last took the meshes of the font */
+
+    size_t                                          mRefined;
+
+    /* Style last asked for, the font keeps drawing the old one until the
+       rebuild is done */
+
+    VectorFont::GlyphStyle                          mStyle;
 };
 
 #endif // ECV_H
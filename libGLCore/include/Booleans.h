@@ -0,0 +1,33 @@
+/* Copyright by János Klingl in 2023 */
+
+#ifndef BOOLEANS_H
+#define BOOLEANS_H
+
+#include "Faces.h"
+#include <vector>
+#include <utility>
+
+/* Sweep-line boolean operations on Faces. Input contours are evaluated with
+   the non-zero winding rule, so holes have to run opposite to their outline.
+   Results are returned with clockwise outlines and counter-clockwise holes,
+   the same orientation FaceGeneators::drill produces. */
+
+struct FaceBooleans
+{
+    enum BOOLOP {
+        BO_UNION,
+        BO_INTERSECTION,
+        BO_DIFFERENCE,
+        BO_XOR
+    };
+    static Faces                            compute( const Faces &subject, const Faces &clip, BOOLOP operation );
+    static Faces                            unite( const Faces &subject, const Faces &clip );
+    static Faces                            intersect( const Faces &subject, const Faces &clip );
+    static Faces                            subtract( const Faces &subject, const Faces &clip );
+    static Faces                            resolve( const Faces &faces );
+    static std::vector< std::pair< Face, std::vector< Face >>> group( const Faces &faces );
+    static float                            area( const Face &polygon );
+    static bool                             contains( const Face &polygon, const Vector2D &point );
+};
+
+#endif // BOOLEANS_H
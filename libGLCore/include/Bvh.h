@@ -0,0 +1,119 @@
+/* Copyright by János Klingl in 2023 */
+
+#ifndef BVH_H
+#define BVH_H
+
+#include "Core.h"
+#include "Graphics.h"
+#include <vector>
+
+/* Half line used for picking and ray queries */
+
+struct Ray
+{
+    Vector3D                                origin;
+    Vector3D                                direction;
+                                            Ray();
+                                            Ray( const Vector3D &origin, const Vector3D &direction );
+    Vector3D                                at( float distance ) const;
+    static Ray                              fromScreen( const Matrix &inverse, float x, float y );
+};
+
+/* Axis aligned bounding box */
+
+struct AABB
+{
+    Vector3D                                min;
+    Vector3D                                max;
+                                            AABB();
+    void                                    grow( const Vector3D &point );
+    void                                    grow( const AABB &other );
+    bool                                    isEmpty() const;
+    Vector3D                                center() const;
+    float                                   area() const;
+    float                                   distance( const Vector3D &point ) const;
+    bool                                    contains( const Vector3D &point ) const;
+    bool                                    intersect( const Ray &ray, float maxDistance, float &distance ) const;
+    AABB                                    transformed( const Matrix &matrix ) const;
+};
+
+/* Result of a ray or point query */
+
+struct RayHit
+{
+    float                                   distance;
+    int                                     triangle;
+    int                                     instance;
+    Vector3D                                point;
+                                            RayHit();
+};
+
+/* Bounding volume hierarchy over a list of boxes, built with binned SAH.
+   Leaves reference a range of items, an inner node has its children at
+   first and first + 1 */
+
+struct BVH
+{
+    struct Node
+    {
+        AABB                                box;
+        int                                 first;
+        int                                 count;
+    };
+    std::vector< Node >                     nodes;
+    std::vector< int >                      items;
+    void                                    build( const std::vector< AABB > &boxes, ThreadPool *pool = nullptr );
+    void                                    refit( const std::vector< AABB > &boxes );
+    void                                    clear();
+    bool                                    isEmpty() const;
+    const AABB                             &bounds() const;
+};
+
+/* Hierarchy over the triangles of a mesh. The mesh has to outlive it */
+
+struct MeshBVH
+{
+    const Mesh                             *mesh;
+    BVH                                     tree;
+                                            MeshBVH();
+    void                                    build( const Mesh &mesh, ThreadPool *pool = nullptr );
+    bool                                    intersect( const Ray &ray, RayHit &hit ) const;
+    bool                                    nearest( const Vector3D &point, float maxDistance, RayHit &hit ) const;
+};
+
+/* Top level hierarchy over placed instances of mesh hierarchies. Moved
+   instances are refitted, the tree is not rebuilt. Distances are measured
+   in the scene, the local query radius is widened by the scaling of the
+   inverse transform. Instances retired from the front stay in the tree
+   until update rebuilds it, instances added since are tested one by one.
+   Indices count from the first instance not retired */
+
+struct SceneBVH
+{
+    static const size_t                     pendingLimit = 256;
+
+    struct Instance
+    {
+        const MeshBVH                      *bvh;
+        Matrix                              transform;
+        Matrix                              inverse;
+        float                               stretch;
+    };
+    std::vector< Instance >                 instances;
+    BVH                                     tree;
+    size_t                                  retired;
+    size_t                                  covered;
+                                            SceneBVH();
+    void                                    clear();
+    size_t                                  size() const;
+    int                                     addInstance( const MeshBVH *bvh, const Matrix &transform );
+    void                                    place( int index, const Matrix &transform );
+    void                                    retire( size_t count );
+    void                                    build( ThreadPool *pool = nullptr );
+    void                                    update( ThreadPool *pool = nullptr );
+    void                                    refit();
+    bool                                    intersect( const Ray &ray, RayHit &hit ) const;
+    bool                                    nearest( const Vector3D &point, float maxDistance, RayHit &hit ) const;
+};
+
+#endif // BVH_H
@@ -10,6 +10,12 @@
 #include <stdarg.h>
 #include <memory>
 #include <chrono>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 
 /* This class reads a file to the memory */
 
@@ -21,6 +27,21 @@ struct FileBuffer
     bool openAndRead( const char *filename );
 };
 
+/* This class maps a file to the memory for reading, on Windows it reads
+   the file into a buffer instead */
+
+struct MappedFile
+{
+    size_t size;
+    const unsigned char *data;
+    MappedFile( const char *filename = nullptr );
+    MappedFile( const MappedFile &other ) = delete;
+    MappedFile &operator = ( const MappedFile &other ) = delete;
+    ~MappedFile();
+    bool open( const char *filename );
+    void close();
+};
+
 /* This class provides extra funcionality to std::string */
 
 class corestring : public std::string {
@@ -53,6 +74,27 @@ public:
     float duration() { return std::chrono::duration_cast<TimeT>( ClockT::now() - from ).count() * 1e-3; }
 };
 
+/* Fixed size pool of worker threads. parallelFor lets the calling thread
+   work on the loop too, so it can be called from inside a task as well */
+
+class ThreadPool
+{
+public:
+    ThreadPool( int workers = 0 );
+    ~ThreadPool();
+    int                                     size() const;
+    void                                    run( const std::function< void() > &task );
+    void                                    parallelFor( size_t count, const std::function< void( size_t ) > &body );
+    static ThreadPool                      &global();
+private:
+    void                                    work();
+    std::vector< std::thread >              workers;
+    std::deque< std::function< void() >>    tasks;
+    std::mutex                              mutex;
+    std::condition_variable                 wake;
+    bool                                    stopping;
+};
+
 /* Used for generate pseudo random numbers */
 
 extern int get_rnd( int min, int max );
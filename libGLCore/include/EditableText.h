@@ -0,0 +1,71 @@
+/* Copyright by János Klingl in 2023 */
+
+#ifndef EDITABLETEXT_H
+#define EDITABLETEXT_H
+
+#include "VectorFont.h"
+#include <string>
+#include <vector>
+
+/* Text mesh that follows edits line by line. Editing marks lines dirty and
+   update lays out and meshes only those, then patches their ranges of the
+   combined mesh. Every line owns a slot of vertices and indices with some
+   slack; a line that outgrows its slot moves to the end of the mesh and the
+   old slot turns into degenerate triangles until the next compaction.
+   Inserting or erasing lines moves the lines below without laying them out.
+   A line holds the glyph meshes it was built from, when the font replaces
+   meshes only the lines using replaced ones are built again */
+
+struct EditableText
+{
+    struct Line
+    {
+        string                                      text;
+        VectorFont::Layout                          placements;
+        std::vector< VectorFont::GlyphMesh >        meshes;
+        int                                         incoming;
+        int                                         outgoing;
+        float                                       y;
+        size_t                                      firstVertex;
+        size_t                                      vertexCount;
+        size_t                                      vertexCapacity;
+        size_t                                      firstIndex;
+        size_t                                      indexCount;
+        size_t                                      indexCapacity;
+        bool                                        dirty;
+                                                    Line( const string &text = string() );
+    };
+
+    /* Part of the mesh rewritten by the last update, for partial uploads */
+
+    struct Range
+    {
+        size_t                                      first;
+        size_t                                      count;
+    };
+
+    VectorFont                                     &font;
+    std::vector< Line >                             lines;
+    Triangles                                       mesh;
+    std::vector< Range >                            vertexPatches;
+    std::vector< Range >                            indexPatches;
+    size_t                                          unusedVertices;
+    uint64_t                                        meshVersion;
+
+                                                    EditableText( VectorFont &font, const string &text = string() );
+    void                                            setText( const string &text );
+    void                                            setLine( size_t line, const string &text );
+    void                                            insertLine( size_t line, const string &text );
+    void                                            eraseLine( size_t line );
+    string                                          text() const;
+    size_t                                          update();
+private:
+    void                                            relayout( Line &line, size_t number, int previous );
+    bool                                            replaced( const Line &line ) const;
+    void                                            remesh( Line &line );
+    void                                            release( Line &line );
+    void                                            move( Line &line, size_t number, float y );
+    void                                            compact();
+};
+
+#endif // EDITABLETEXT_H
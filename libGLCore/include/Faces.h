@@ -22,8 +22,10 @@ struct Faces : public vector<Face>
 {
                                             Faces();
                                             Faces( const Face &polygon );
-                                            Faces( vector<Face> &faces);
-    void                                    shift( Vector2D shift );
+                                            Faces( Face &&polygon );
+                                            Faces( const vector<Face> &faces );
+                                            Faces( vector<Face> &&faces );
+    void                                    shift( const Vector2D &shift );
 };
 
 /* Bounding box structure for extending Face structure */
@@ -36,10 +38,13 @@ struct BBoxFace : public Face
     float                                   maxy;
                                             BBoxFace();
                                             BBoxFace( const BBoxFace &src );
+                                            BBoxFace( BBoxFace &&src );
                                             BBoxFace( const Face &src );
                                             BBoxFace &operator = ( const BBoxFace &src );
-    void                                    addPoint( const Vector2D pnt );
+                                            BBoxFace &operator = ( BBoxFace &&src );
+    void                                    addPoint( const Vector2D &pnt );
     int                                     checkRelation( const BBoxFace &other );
+    bool                                    overlaps( const BBoxFace &other ) const;
     void                                    grow( const BBoxFace &other );
     void                                    setBox( const BBoxFace &other );
 };
@@ -66,10 +71,10 @@ struct TriangleGeneators;
 struct FaceGeneators
 {
     friend struct TriangleGeneators;
-    static Face                             grow( const Face polygon, float width );
+    static Face                             grow( const Face &polygon, float width );
     static Face                             roundedRect( float height, float width, float radius, int step );
-    static Face                             drill( const Face polygon, const Faces holes );
-    static Tangents                         generateTangents( const Face polygon );
+    static Face                             drill( const Face &polygon, const Faces &holes );
+    static Tangents                         generateTangents( const Face &polygon );
     static bool                             checkOrientation( const Face &polygon );
 };
 
@@ -102,6 +102,7 @@ public:
     void resetProgream();
     void enablePosition( bool enable = true );
     void enableNormal( bool enable = true );
+    void enableTexCoord( bool enable = true );
     void setUniform( const char *value, const float f1 );
     void setUniform( const char *value, const float f1, const float f2 );
     void setUniform( const char *value, const float f1, const float f2, const float f3 );
@@ -110,11 +111,13 @@ public:
     void setUniform( const char *value, const Vector3D &vector3d );
     void setUniform( const char *value, const Matrix &matrix );
     void drawMesh( const Mesh &mesh ) const;
+    void drawMesh( const TexturedMesh &mesh ) const;
 protected:
     GLuint mProgram;
     GLuint mUPos;
     GLuint mPositionAttribute;
     GLuint mNormalAttribute;
+    GLuint mTexCoordAttribute;
 };
 
 #endif // GLCORE_H
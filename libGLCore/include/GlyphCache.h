@@ -0,0 +1,74 @@
+/* Copyright by János Klingl in 2023 */
+
+#ifndef GLYPHCACHE_H
+#define GLYPHCACHE_H
+
+#include "VectorFont.h"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/* Glyph meshes of several fonts and styles under one memory budget. The
+   fonts keep outlines and kerning only, a mesh is extruded on a miss and the
+   least recently used meshes are dropped when the budget is exceeded. Meshes
+   still referenced by a text stay alive until that text releases them, a
+   miss meanwhile takes such a mesh back instead of extruding a second copy.
+   The fonts fetch their meshes from the cache, so their own layout and
+   mesh calls work as well. A font made elsewhere can be added too, it has
+   to be initialized with keepMeshes off and outlive the cache */
+
+struct GlyphCache
+{
+    struct Counters
+    {
+        size_t                              hits;
+        size_t                              misses;
+        size_t                              evictions;
+        size_t                              meshes;
+        size_t                              bytes;
+    };
+
+                                            GlyphCache( size_t budget = 64 << 20 );
+                                            ~GlyphCache();
+    int                                     addFont( const std::map< long, std::vector<std::vector<std::pair<double,double>>>> &font_src, float grow = 0.1f, float depth = 0.3f, float bevel = 0.06, int roundStep = 1 );
+    int                                     addFont( VectorFont &font );
+    VectorFont                             &font( int font );
+    VectorFont::GlyphMesh                   mesh( int font, int glyph );
+    VectorFont::Text3D                      placeChars( int font, const VectorFont::Layout &placements );
+    void                                    setBudget( size_t budget );
+    void                                    clear();
+    Counters                                counters() const;
+    void                                    report() const;
+private:
+    struct Entry
+    {
+        int                                 font;
+        int                                 glyph;
+    };
+    struct Slot
+    {
+        VectorFont::GlyphMesh               mesh;
+        std::weak_ptr< const Triangles >    evicted;
+        size_t                              bytes;
+        std::list< Entry >::iterator        use;
+    };
+    struct Font
+    {
+        std::unique_ptr< VectorFont >       owned;
+        VectorFont                         *font;
+        std::vector< Slot >                 slots;
+    };
+
+    int                                     attach( std::unique_ptr< Font > entry );
+    void                                    store( Slot &slot, int font, int glyph, const VectorFont::GlyphMesh &mesh );
+    void                                    trim();
+
+    size_t                                  budget;
+    std::vector< std::unique_ptr< Font >>   fonts;
+    std::list< Entry >                      recent;
+    Counters                                stats;
+    mutable std::mutex                      mutex;
+};
+
+#endif // GLYPHCACHE_H
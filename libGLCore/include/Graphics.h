@@ -68,9 +68,9 @@ struct Vector3D
     Vector3D &operator = ( const Vector3D &other );
     Vector3D( const Vector2D &other );
     void operator *= ( float scale );
-    void operator *= ( const Vector3D scale );
-    void operator -= ( const Vector3D translate );
-    void operator += ( const Vector3D translate );
+    void operator *= ( const Vector3D &scale );
+    void operator -= ( const Vector3D &translate );
+    void operator += ( const Vector3D &translate );
     float length() const;
     bool isEmpty() const;
     Vector3D normalized() const;
@@ -123,6 +123,8 @@ struct Matrix
     void scale( const Vector3D &scale );
     void ortho( const float bottom, const float top, const float left, const float right, const float nearplane, const float farplane );
     void perspective( const float fov, const float aspect, const float nearplane, const float farplane );
+    Matrix inverted() const;
+    Vector3D project( const Vector3D &point ) const;
 };
 
 inline float angleToDist( float angle ) {
@@ -132,17 +134,19 @@ inline float angleToDist( float angle ) {
 
 /* 4x4 Matrix operations */
 
-Matrix operator * ( const Matrix mat1, const Matrix mat2 );
-Vector3D operator * ( const Matrix matrix, const Vector3D point );
+Matrix operator * ( const Matrix &mat1, const Matrix &mat2 );
+Vector3D operator * ( const Matrix &matrix, const Vector3D &point );
 
 /* Plane declaration as vector of 2D Vectors and additional functions */
 
 struct Plane : public vector<Vector2D>
 {
                                             Plane();
-                                            Plane( vector<Vector2D> &points );
+                                            Plane( const vector<Vector2D> &points );
+                                            Plane( vector<Vector2D> &&points );
     const Plane                             reversed() const;
-    void                                    shift( Vector2D shift );
+    void                                    reverse();
+    void                                    shift( const Vector2D &shift );
 };
 
 /* 3D Mesh structure declaration with storage and manipulation */
@@ -152,15 +156,26 @@ struct Mesh
     vector<Vector3D>                        mVertices;
     vector<Vector3D>                        mNormals;
     vector<uint>                            mIndices;
-    int                                     addVertex( const Vector3D pos, const Vector3D norm );
+    int                                     addVertex( const Vector3D &pos, const Vector3D &norm );
     Mesh                                   *flip();
-    Mesh                                   *shift( const Vector3D shift );
-    Mesh                                   *rotate( const float angle, const Vector3D axis );
+    Mesh                                   *shift( const Vector3D &shift );
+    Mesh                                   *rotate( const float angle, const Vector3D &axis );
     Mesh                                   *scale( float scale );
-    Mesh                                   *transform( const Matrix matrix );
+    Mesh                                   *transform( const Matrix &matrix );
     void                                    operator += ( const Mesh &other );
+    void                                    operator += ( Mesh &&other );
     Mesh                                    optimized();
     void                                    clear();
 };
 
+/* Mesh with texture coordinates instead of normals */
+
+struct TexturedMesh
+{
+    vector<Vector3D>                        mVertices;
+    vector<Vector2D>                        mTexCoords;
+    vector<uint>                            mIndices;
+    void                                    clear();
+};
+
 #endif // GRAPHICS_H
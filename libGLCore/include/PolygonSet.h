@@ -0,0 +1,52 @@
+/* Copyright by János Klingl in 2023 */
+
+#ifndef POLYGONSET_H
+#define POLYGONSET_H
+
+#include "Graphics.h"
+#include "Faces.h"
+#include <vector>
+#include <utility>
+
+/* Contours of one or more shapes in a single point buffer. Contour i spans
+   points offsets[ i ] to offsets[ i + 1 ], parents holds the outer contour of
+   a hole or -1 and boxes the minx, miny, maxx, maxy of every contour. Raw
+   glyph outlines have no parents yet, VectorFont::groupContours sets them */
+
+struct PolygonSet
+{
+    struct Box
+    {
+        float                               minx;
+        float                               miny;
+        float                               maxx;
+        float                               maxy;
+    };
+
+    vector< Vector2D >                      points;
+    vector< uint >                          offsets;
+    vector< int >                           parents;
+    vector< Box >                           boxes;
+
+                                            PolygonSet();
+    void                                    clear();
+    bool                                    isEmpty() const;
+    size_t                                  contourCount() const;
+    size_t                                  contourSize( size_t contour ) const;
+    const Vector2D                         *contour( size_t contour ) const;
+    int                                     addContour( const Vector2D *begin, size_t count, int parent = -1 );
+    int                                     addContour( const Face &face, int parent = -1 );
+    void                                    append( const PolygonSet &other );
+    void                                    reverse( size_t contour );
+    void                                    reverse();
+    void                                    computeBoxes();
+    void                                    shrinkToFit();
+    Box                                     bounds() const;
+    Face                                    face( size_t contour ) const;
+    Faces                                   holes( size_t contour ) const;
+    BBoxFace                                boxFace( size_t contour ) const;
+    std::vector< std::pair< Face, std::vector< Face >>> grouped() const;
+    static PolygonSet                       fromGrouped( const std::vector< std::pair< Face, std::vector< Face >>> &polys );
+};
+
+#endif // POLYGONSET_H
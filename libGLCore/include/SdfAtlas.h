@@ -0,0 +1,41 @@
+/* Copyright by János Klingl in 2023 */
+
+#ifndef SDFATLAS_H
+#define SDFATLAS_H
+
+#include "VectorFont.h"
+#include <vector>
+
+/* Signed distance fields of the glyph outlines packed into a single channel
+   atlas. The outline is at 128, values grow inside and fall outside by 127
+   per spread glyph units. Flat text becomes one textured quad per character */
+
+struct SdfAtlas
+{
+    /* Atlas rectangle of a glyph and the glyph space area it covers */
+
+    struct Cell
+    {
+        int                                 x;
+        int                                 y;
+        int                                 width;
+        int                                 height;
+        float                               minx;
+        float                               miny;
+        float                               maxx;
+        float                               maxy;
+    };
+
+    float                                   pixelsPerUnit;
+    float                                   spread;
+    int                                     width;
+    int                                     height;
+    std::vector< unsigned char >            pixels;
+    std::vector< Cell >                     cells;
+
+                                            SdfAtlas();
+    void                                    build( VectorFont &font, ThreadPool *pool = nullptr );
+    TexturedMesh                            genText( const VectorFont::Layout &placements ) const;
+};
+
+#endif // SDFATLAS_H
@@ -4,23 +4,64 @@
 #define TRIANGLES_H
 
 #include "Faces.h"
+#include "Core.h"
 #include <vector>
 
 typedef Mesh Triangles;
 
+/* Microseconds spent in the stages of the generators. While a thread has a
+   profile set by a Scope, the stages it runs add their time to it */
+
+struct BuildProfile
+{
+    enum Stage
+    {
+        Drill,
+        FillFace,
+        Bevel,
+        Cylinder,
+        Optimize,
+        StageCount
+    };
+
+    struct Scope
+    {
+        BuildProfile                       *previous;
+                                            Scope( BuildProfile *profile );
+                                            ~Scope();
+    };
+
+    /* Adds the time until it goes out of scope to a stage */
+
+    struct Timing
+    {
+        BuildProfile                       *profile;
+        Stage                               stage;
+        Timer< std::chrono::nanoseconds >   timer;
+                                            Timing( Stage stage );
+                                            ~Timing();
+    };
+
+    float                                   micros[ StageCount ];
+                                            BuildProfile();
+    float                                   total() const;
+    static BuildProfile                    *&current();
+    static const char                      *stageName( int stage );
+};
+
 /* This structure provides generators for 3D objects */
 
 struct TriangleGeneators
 {
     static float                            auto_smooth_angle;
-    static Triangles                        bevelEdge( const Face polygon, float height, float depth, float radius, int slices, bool smooth );
-    static Triangles                        bevelExtrude( const Face polygon, float height, float radius, int slices, bool smooth, bool cap = true );
-    static Triangles                        bevelExtrude( const Face polygon, Faces holes, float height, float radius, int slices, bool smooth, bool cap = true );
-    static Triangles                        revolution( const Faces polygons, float radius, float angleStep, bool smooth, bool close );
-    static void                             bevel( Triangles &triangles, const Face polygon, float depth, float radius, float slices, bool flip, bool in );
-    static void                             cylinder( Triangles &triangles, const Face polygon, float depth, bool smooth, bool cw );
-    static void                             fillEdge( Triangles &triangles, const Face polygon, float width, float depth, bool cw );
-    static void                             fillFace( Triangles &triangles, const Face polygon, float depth, bool bottom );
+    static Triangles                        bevelEdge( const Face &polygon, float height, float depth, float radius, int slices, bool smooth );
+    static Triangles                        bevelExtrude( const Face &polygon, float height, float radius, int slices, bool smooth, bool cap = true );
+    static Triangles                        bevelExtrude( const Face &polygon, const Faces &holes, float height, float radius, int slices, bool smooth, bool cap = true );
+    static Triangles                        revolution( const Faces &polygons, float radius, float angleStep, bool smooth, bool close );
+    static void                             bevel( Triangles &triangles, const Face &polygon, float depth, float radius, float slices, bool flip, bool in );
+    static void                             cylinder( Triangles &triangles, const Face &polygon, float depth, bool smooth, bool cw );
+    static void                             fillEdge( Triangles &triangles, const Face &polygon, float width, float depth, bool cw );
+    static void                             fillFace( Triangles &triangles, const Face &polygon, float depth, bool bottom );
 };
 
 #endif // TRIANGLES_H
@@ -0,0 +1,50 @@
+/* Copyright by János Klingl in 2023 */
+
+#ifndef TRUETYPEFONT_H
+#define TRUETYPEFONT_H
+
+#include "Core.h"
+#include <map>
+#include <vector>
+#include <utility>
+#include <memory>
+
+struct stbtt_fontinfo;
+
+/* Glyph outlines read from a memory mapped TrueType file. Only the glyphs
+   asked for are decoded, curves are flattened into the contours taken by
+   VectorFont::Init. The em is 2.048 units, the size of the outlines written
+   by fontParser, and the contours run the same way.
+
+   A curve is cut into steps segments, or, with a tolerance above zero, into
+   as few segments as keep it within tolerance outline units. The curves stay
+   in the mapped file, so glyphs can be decoded again at another detail level */
+
+struct TrueTypeFont
+{
+    typedef std::vector< std::vector< std::pair< double, double >>> Outlines;
+    typedef std::map< long, Outlines > Source;
+
+    static const int                        maxSegments = 64;
+
+    int                                     steps;
+    float                                   tolerance;
+
+                                            TrueTypeFont( const char *filename = nullptr );
+                                            TrueTypeFont( const TrueTypeFont &other ) = delete;
+    TrueTypeFont                           &operator = ( const TrueTypeFont &other ) = delete;
+                                            ~TrueTypeFont();
+    bool                                    open( const char *filename );
+    void                                    close();
+    bool                                    isOpen() const;
+    bool                                    hasGlyph( long charID ) const;
+    Outlines                                outlines( long charID ) const;
+    Source                                  source( const std::vector< char32_t > &charIDs ) const;
+    static float                            toleranceFor( float pixelsPerEm, float pixelError = 0.25f );
+private:
+    MappedFile                              file;
+    std::unique_ptr< stbtt_fontinfo >       info;
+    float                                   scale;
+};
+
+#endif // TRUETYPEFONT_H
@@ -0,0 +1,34 @@
+/* Copyright by János Klingl in 2023 */
+
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/* Streaming UTF-8 decoder for the full Unicode range. Invalid bytes, overlong
+   forms and surrogates decode to U+FFFD, one replacement per maximal invalid
+   subpart. A sequence split between two feed calls is completed by the next
+   call, finish flushes an incomplete tail. boundary moves a cut position back
+   to the start of the sequence it falls into */
+
+class Utf8Decoder
+{
+public:
+    static const char32_t                   replacement = 0xfffd;
+                                            Utf8Decoder();
+    void                                    feed( const char *data, size_t size, std::vector< char32_t > &codepoints );
+    void                                    finish( std::vector< char32_t > &codepoints );
+    void                                    reset();
+    static void                             decode( const std::string &text, std::vector< char32_t > &codepoints );
+    static char32_t                         next( const char *&pos, const char *end );
+    static int                              encode( char32_t codepoint, char *out );
+    static size_t                           boundary( const std::string &text, size_t pos );
+    static size_t                           boundary( const char *text, size_t size, size_t pos );
+private:
+    unsigned char                           pending[ 4 ];
+    int                                     pendingSize;
+};
+
+#endif // UTF8_H
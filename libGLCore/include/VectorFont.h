@@ -4,30 +4,49 @@
 #define VECTORFONT_H
 
 #include <map>
+#include <functional>
+#include <unordered_map>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <cstdint>
 #include "Faces.h"
 #include "Triangles.h"
+#include "Bvh.h"
+#include "PolygonSet.h"
 
 class BBoxFace;
 
-/* Store and help to calculate font kerning */
+/* Directions sampled by the kerning profiles, shared by all glyphs of a
+   font. The samples are padded to whole SIMD lanes with copies of the last
+   direction, which leave the minimum of a pair unchanged */
+
+struct KerningAngles
+{
+    static const int lanes = 4;
+    std::vector<float> angleScales;
+    std::vector<float> scales;
+    int samples;
+    KerningAngles( float angle, int dirsteps );
+    static std::shared_ptr< const KerningAngles > standard();
+};
+
+/* Store and help to calculate font kerning. The leftmost and rightmost
+   extents along every sampled direction are kept in two flat arrays */
 
 struct ZeroX
 {
+    std::shared_ptr< const KerningAngles > angles;
     std::vector<float> leftPos;
     std::vector<float> rightPos;
-    std::vector<float> angleScales;
-    std::vector<float> scales;
     bool first;
     float dy;
-    ZeroX();
-    ZeroX( const ZeroX &other );
-    ZeroX * operator = ( const ZeroX &other );
-    void setAngles( float angle, int dirsteps );
+    ZeroX( std::shared_ptr< const KerningAngles > angles = KerningAngles::standard() );
     void setRange( float minx, float maxx );
-    float calcPos( float angleScale, const Vector2D &point );
-    float getMin( const ZeroX &previous, float gap );
+    float getDistance( const ZeroX &previous ) const;
+    float getMin( const ZeroX &previous, float gap ) const;
     void addFace( const Face &face );
 };
 
@@ -37,42 +56,315 @@ struct KerningSource
 {
     ZeroX zerox;
     BBoxFace bBox;
-    KerningSource();
-    KerningSource( const KerningSource &other );
-    KerningSource * operator = ( const KerningSource &other );
+    KerningSource( std::shared_ptr< const KerningAngles > angles = KerningAngles::standard() );
     void calc();
     void addFace( const Face &face );
-    float getWidth();
-    float getKerning( KerningSource *prevChar, float gap );
+    float getWidth() const;
+    float getKerning( const KerningSource *prevChar, float gap ) const;
+};
+
+/* Two level page table from codepoints to glyph indices. Missing pages all
+   point to a shared page of -1 entries, so a lookup never branches on them */
+
+struct CodepointTable
+{
+    static const long                       pageBits = 8;
+    static const long                       pageSize = 1 << pageBits;
+    static const long                       codepointLimit = 0x110000;
+    std::vector< int32_t >                  directory;
+    std::vector< int32_t >                  pages;
+                                            CodepointTable();
+    void                                    clear();
+    void                                    insert( long codepoint, int index );
+    int                                     find( long codepoint ) const;
 };
 
 /* Storage and handlers of vector fonts */
 
 struct VectorFont
 {
+    /* Glyph meshes are shared and never change once built. A progressive font
+       replaces the draft mesh of a glyph with the refined one as a whole */
+
+    typedef std::shared_ptr< const Triangles > GlyphMesh;
+
+    /* Parameters of the extruded glyph geometry */
+
+    struct GlyphStyle
+    {
+        float                                       grow;
+        float                                       depth;
+        float                                       bevel;
+        int                                         roundStep;
+    };
+
+    /* Picking hierarchy of a glyph mesh, built on first use from the mesh of
+       that moment. The mesh is held, as the hierarchy points into it */
+
+    struct GlyphBVH
+    {
+        MeshBVH                                     bvh;
+        GlyphMesh                                   mesh;
+        std::once_flag                              once;
+    };
+
+    /* All data of a glyph, kept together in the glyph table. The outlines are
+       kept for deferred builds and for the distance field atlas, polys holds
+       them grouped, every hole pointing at its outer contour. A deferred
+       glyph fills its mutable members once, const readers may trigger it */
+
+    struct Glyph
+    {
+        long                                        charID;
+        BBoxFace                                    box;
+        float                                       width;
+        mutable GlyphMesh                           mesh;
+        mutable KerningSource                       kerning;
+        mutable PolygonSet                          polys;
+        PolygonSet                                  outlines;
+        bool                                        deferred;
+        mutable std::once_flag                      built;
+        GlyphBVH                                    picking;
+                                                    Glyph();
+    };
+
+    /* Build cost and size of a glyph. The stages add up over every build
+       of the glyph, drafts included, the counts are of its current mesh */
+
+    struct GlyphReport
+    {
+        long                                        charID;
+        size_t                                      contours;
+        size_t                                      points;
+        size_t                                      vertices;
+        size_t                                      triangles;
+        size_t                                      bytes;
+        float                                       groupMicros;
+        float                                       kerningMicros;
+        BuildProfile                                stages;
+        float                                       total() const;
+    };
+
+    /* Everything built for a single glyph */
+
+    struct GlyphBuild
+    {
+        PolygonSet                                  polys;
+        Triangles                                   mesh;
+        KerningSource                               kerning;
+        GlyphReport                                 report;
+    };
+
     float                                           minx;
     float                                           gap;
-    std::map< long, BBoxFace >                      letter_boxes;
-    std::map< long, KerningSource>                  kernings;
-    std::map< long, std::vector< std::pair< Face, std::vector< Face >>>> characters;
-    std::map< long, Triangles >                     letters;
+    bool                                            mergeOverlaps;
+    int                                             workers;
+    bool                                            lazy;
+
+    /* Without kept meshes glyphs are laid out but never extruded, the meshes
+       are left to an owner like GlyphCache and glyph.mesh stays empty.
+       glyphMesh then asks meshSource, or extrudes a mesh it does not keep */
+
+    bool                                            keepMeshes;
+    std::function< GlyphMesh( int ) >               meshSource;
+
+    /* A progressive font builds flat draft meshes without bevels in Init and
+       refines them on a thread of its own. Meshes are read with glyphMesh
+       meanwhile, refinedGlyphs counts the glyphs already swapped.
+       meshVersion steps whenever meshes already handed out are replaced, by
+       a refine, a restyle, compact or Init, so holders know to fetch again */
+
+    bool                                            progressive;
+    std::thread                                     refiner;
+    std::atomic< bool >                             stopRefining;
+    std::atomic< size_t >                           refinedGlyphs;
+    std::atomic< uint64_t >                         meshVersion;
+
+    /* A restyle extrudes every glyph again on the refiner thread while the
+       current meshes stay in use. applyRestyle swaps the finished set in at
+       once, and the kerning as well when the grow changed. A reflatten does
+       the same from new outlines, which are swapped in with the meshes. The
+       outlines may come from restyledSource, which then runs on the refiner
+       and survives a restyle started before it ran.
+       The cache of the new style is then written by cacheWriter, which
+       Init, applyRestyle and compact wait for before changing glyphs */
+
+    GlyphStyle                                      restyledStyle;
+    std::vector< GlyphMesh >                        restyledMeshes;
+    std::vector< KerningSource >                    restyledKerning;
+    std::vector< PolygonSet >                       restyledOutlines;
+    std::vector< PolygonSet >                       restyledPolys;
+    std::function< std::map< long, std::vector<std::vector<std::pair<double,double>>>>() > restyledSource;
+    std::atomic< bool >                             restyleReady;
+    std::thread                                     cacheWriter;
+
+    /* With profileBuild set the glyph builds are timed into buildReport, one
+       entry per glyph. A progressive font completes it once refined */
+
+    bool                                            profileBuild;
+    mutable std::vector< GlyphReport >              buildReport;
+
+    /* Kerning directions on each side within 20 degrees. The default two
+       give five samples in eight lanes, three fill the lanes at the same cost */
+
+    int                                             kerningSteps;
+    string                                          cachePath;
+
+    /* Hash of the outlines the cache keys are made of, zero once a
+       reflatten replaced them */
+
+    uint64_t                                        sourceKey;
+    GlyphStyle                                      style;
+    std::vector< Glyph >                            glyphs;
+    CodepointTable                                  glyphIndex;
+    std::shared_ptr< const KerningAngles >          kerningAngles;
+
+    /* Kerning of the pairs before the gap is applied. The table holds every
+       pair once all glyphs are built, in lazy mode pairs go to the map on
+       first use. A font of more than kerningTableLimit glyphs never gets a
+       table, its square would outgrow the pairs any text uses, and keeps
+       its profiles through compact. Otherwise after compact the profiles
+       and outlines are gone */
+
+    size_t                                          kerningTableLimit;
+    std::vector< float >                            kerningTable;
+    mutable std::unordered_map< uint64_t, float >   kerningPairs;
+    mutable std::mutex                              kerningMutex;
+    bool                                            frozen;
 
     struct Char3D
     {
-        Triangles                                   geometry;
+        GlyphMesh                                   geometry;
         Vector3D                                    pos;
+        long                                        charID;
+        int                                         line;
+    };
+
+    /* Position of a glyph in a laid out text */
+
+    struct Placement
+    {
+        long                                        charID;
+        int                                         glyph;
+        float                                       x;
+        float                                       y;
+        int                                         line;
+    };
+
+    /* Resident bytes of a font by category */
+
+    struct MemoryReport
+    {
+        size_t                                      outlines;
+        size_t                                      contours;
+        size_t                                      kerning;
+        size_t                                      meshes;
+        size_t                                      picking;
+        size_t                                      layouts;
+        size_t                                      tables;
+        size_t                                      total() const;
+    };
+
+    typedef std::vector< Placement >                Layout;
+    typedef std::shared_ptr< const Layout >         LayoutPtr;
+
+    /* Strings laid out together into one buffer. String i owns placements
+       from offsets[ i ] up to offsets[ i + 1 ] and starts at line zero */
+
+    struct LayoutBatch
+    {
+        Layout                                      placements;
+        std::vector< size_t >                       offsets;
+    };
+
+    /* Progress of a text laid out one line at a time */
+
+    struct LineCursor
+    {
+        size_t                                      offset;
+        int                                         line;
+        int                                         previous;
+                                                    LineCursor();
     };
 
+    /* Layouts of the most recently laid out strings, at most layoutLimit of
+       them. The least recently used one makes room for a new string */
+
+    struct CachedLayout
+    {
+        LayoutPtr                                   placements;
+        uint64_t                                    used;
+    };
+
+    std::map< string, CachedLayout >                layouts;
+    size_t                                          layoutLimit;
+    uint64_t                                        layoutUses;
+    float                                           layoutGap;
+    mutable std::mutex                              layoutMutex;
+
     VectorFont();
-    void Init( std::map< long, std::vector<std::vector<std::pair<double,double>>>> font_src, float grow = 0.1f, float depth = 0.3f, float bevel = 0.06, int roundStep = 1 );
+    ~VectorFont();
+    void Init( const std::map< long, std::vector<std::vector<std::pair<double,double>>>> &font_src, float grow = 0.1f, float depth = 0.3f, float bevel = 0.06, int roundStep = 1 );
+    PolygonSet                                      groupContours( const PolygonSet &outlines ) const;
+    Triangles                                       extrudeGlyph( const PolygonSet &polys ) const;
+    Triangles                                       extrudeGlyph( const PolygonSet &polys, const GlyphStyle &glyphStyle ) const;
+    GlyphStyle                                      draftStyle() const;
+    KerningSource                                   glyphKerning( long charID, const PolygonSet &polys, float grow ) const;
+    bool                                            restyle( const GlyphStyle &next );
+    bool                                            reflatten( const std::map< long, std::vector<std::vector<std::pair<double,double>>>> &font_src );
+    bool                                            reflatten( const std::function< std::map< long, std::vector<std::vector<std::pair<double,double>>>>() > &source );
+    void                                            beginRestyle( const GlyphStyle &next );
+    void                                            takeOutlines( const std::map< long, std::vector<std::vector<std::pair<double,double>>>> &font_src );
+    void                                            rebuildStyle();
+    bool                                            applyRestyle();
+    void                                            refine( uint64_t key );
+    bool                                            isRefined() const;
+    void                                            waitRefined();
+    void                                            cancelRefining();
+    void                                            waitCacheWritten();
+    GlyphBuild                                      buildGlyph( long charID, const PolygonSet &outlines, bool withMesh = true ) const;
+    Glyph                                          *findGlyph( long charID );
+    void                                            ensureGlyph( long charID );
+    void                                            ensureGlyph( const Glyph &glyph ) const;
+    const MeshBVH                                  &glyphBVH( long charID );
+    void                                            updatePicking();
+    bool                                            loadCache( uint64_t key );
+    bool                                            saveCache( uint64_t key ) const;
+    void                                            writeCache( uint64_t key ) const;
+    void                                            warm( const string &text );
+    void                                            fillKerningPairs( ThreadPool &pool );
+    void                                            resetKerningPairs();
+    const Glyph                                    &readyGlyph( int index ) const;
+    GlyphMesh                                       glyphMesh( int index ) const;
+    void                                            recordBuild( size_t index, const GlyphReport &report ) const;
+    void                                            logBuildReport() const;
+    bool                                            saveBuildReport( const string &path ) const;
+    float                                           pairKerning( int previous, int next ) const;
+    MemoryReport                                    memoryReport() const;
+    void                                            logMemory( const char *title ) const;
+    void                                            compact( ThreadPool *pool = nullptr );
     unsigned long                                   fromUTF8( unsigned long narrow );
     unsigned long                                   toUTF8( unsigned long wide );
     int                                             UTF8len( unsigned long narrow );
 
-    typedef struct std::vector< std::shared_ptr< Char3D >> Text3D;
-    Text3D                                          genTextChars( string text );
-    Triangles                                       genText( string text );
-    Triangles                                       genTextPlane( string text );
+    typedef struct std::vector< Char3D >           Text3D;
+
+    /* The const members below may run on any number of threads at once, as
+       long as no thread changes the font or its gap meanwhile */
+
+    Layout                                          layoutText( const string &text ) const;
+    void                                            layoutCodepoints( const std::vector< char32_t > &codepoints, Layout &placements ) const;
+    void                                            layoutLine( const char32_t *begin, const char32_t *end, int line, float y, int &previous, Layout &placements ) const;
+    bool                                            layoutNextLine( const string &text, LineCursor &cursor, Layout &placements ) const;
+    bool                                            layoutNextLine( const char *text, size_t size, LineCursor &cursor, Layout &placements ) const;
+    LayoutBatch                                     layoutBatch( const std::vector< string > &texts, ThreadPool *pool = nullptr ) const;
+    LayoutPtr                                       layout( const string &text );
+    void                                            clearLayouts();
+    Triangles                                       buildMesh( const Layout &placements ) const;
+    Text3D                                          placeChars( const Layout &placements ) const;
+    Text3D                                          genTextChars( const string &text );
+    Triangles                                       genText( const string &text );
+    Triangles                                       genTextPlane( const string &text );
 };
 
 #endif // VECTORFONT_H
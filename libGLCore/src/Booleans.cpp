@@ -0,0 +1,598 @@
+#include "Booleans.h"
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <queue>
+#include <set>
+#include <unordered_map>
+#include <math.h>
+
+namespace {
+
+/* One end of an edge in the sweep. The left event owns the edge data, the
+   right event only marks where the edge leaves the sweep status. */
+
+struct SweepEvent;
+
+struct EdgeOrder
+{
+    bool operator () ( const SweepEvent *a, const SweepEvent *b ) const;
+};
+
+typedef std::set< SweepEvent*, EdgeOrder > SweepStatus;
+
+struct SweepEvent
+{
+    double                                  x;
+    double                                  y;
+    bool                                    left;
+    SweepEvent                             *other;
+    int                                     id;
+    int                                     winding[ 2 ];
+    int                                     windBelow[ 2 ];
+    int                                     windAbove[ 2 ];
+    bool                                    contributes;
+    bool                                    insideAbove;
+    SweepStatus::iterator                   position;
+};
+
+inline bool pointBefore( double x1, double y1, double x2, double y2 )
+{
+    if( x1 != x2 )
+        return x1 < x2;
+    return y1 < y2;
+}
+
+inline bool samePoint( const SweepEvent *a, const SweepEvent *b )
+{
+    return a->x == b->x && a->y == b->y;
+}
+
+inline double orient( double ax, double ay, double bx, double by, double cx, double cy )
+{
+    return ( bx - ax ) * ( cy - ay ) - ( by - ay ) * ( cx - ax );
+}
+
+/* Positive when the point lies above the edge of the left event */
+
+inline double side( const SweepEvent *le, double x, double y )
+{
+    return orient( le->x, le->y, le->other->x, le->other->y, x, y );
+}
+
+bool eventBefore( const SweepEvent *a, const SweepEvent *b )
+{
+    if( a->x != b->x )
+        return a->x < b->x;
+    if( a->y != b->y )
+        return a->y < b->y;
+    if( a->left != b->left )
+        return !a->left;
+    const SweepEvent *la = a->left ? a : a->other;
+    const double o = side( la, b->other->x, b->other->y );
+    if( o != 0 )
+        return o > 0;
+    return a->id < b->id;
+}
+
+struct EventLater
+{
+    bool operator () ( const SweepEvent *a, const SweepEvent *b ) const
+    {
+        return eventBefore( b, a );
+    }
+};
+
+bool EdgeOrder::operator () ( const SweepEvent *a, const SweepEvent *b ) const
+{
+    if( a == b )
+        return false;
+    double o;
+    if( samePoint( a, b )) {
+        o = side( a, b->other->x, b->other->y );
+        if( o != 0 )
+            return o > 0;
+        return a->id < b->id;
+    }
+    if( eventBefore( a, b )) {
+        o = side( a, b->x, b->y );
+        if( o != 0 )
+            return o > 0;
+        o = side( a, b->other->x, b->other->y );
+        if( o != 0 )
+            return o > 0;
+        return a->id < b->id;
+    }
+    o = side( b, a->x, a->y );
+    if( o != 0 )
+        return o < 0;
+    o = side( b, a->other->x, a->other->y );
+    if( o != 0 )
+        return o < 0;
+    return a->id < b->id;
+}
+
+/* The operation runs in two sweeps. The first one splits the edges at every
+   intersection, the second one merges coincident edges and classifies them
+   by the winding numbers on both of their sides. */
+
+class Sweep
+{
+public:
+    Sweep( FaceBooleans::BOOLOP operation ) : operation( operation ), nextID( 0 ), tolerance( 0 ) {}
+    void                                    addFaces( const Faces &faces, int polygon );
+    void                                    split();
+    void                                    classify();
+    Faces                                   connect();
+private:
+    FaceBooleans::BOOLOP                    operation;
+    int                                     nextID;
+    std::deque< SweepEvent >                events;
+    std::vector< SweepEvent* >              leftEvents;
+    std::priority_queue< SweepEvent*, std::vector< SweepEvent* >, EventLater > queue;
+    SweepStatus                             status;
+    double                                  tolerance;
+    std::unordered_map< long long, std::vector< std::pair< double, double >>> vertices;
+
+    long long                               cellKey( long long cx, long long cy ) const;
+    void                                    addVertex( double x, double y );
+    bool                                    within( const SweepEvent *le, double x, double y ) const;
+    void                                    snap( double &x, double &y, const SweepEvent *a, const SweepEvent *b );
+    SweepEvent                             *newEvent( double x, double y, bool left );
+    void                                    addEdge( double x1, double y1, double x2, double y2, const int winding[ 2 ] );
+    bool                                    inside( const int wind[ 2 ] ) const;
+    void                                    computeFields( SweepEvent *le, SweepEvent *prev );
+    SweepEvent                             *divide( SweepEvent *le, double x, double y );
+    void                                    possibleIntersection( SweepEvent *a, SweepEvent *b );
+    void                                    run( bool splitting );
+};
+
+SweepEvent *Sweep::newEvent( double x, double y, bool left )
+{
+    events.push_back( SweepEvent() );
+    SweepEvent *event = &events.back();
+    event->x = x;
+    event->y = y;
+    event->left = left;
+    event->other = nullptr;
+    event->id = nextID++;
+    event->contributes = false;
+    event->insideAbove = false;
+    for( int p = 0; p < 2; ++p )
+        event->winding[ p ] = event->windBelow[ p ] = event->windAbove[ p ] = 0;
+    return event;
+}
+
+/* The winding of an edge is what it adds to the winding numbers when it is
+   crossed from below, so an edge running to the left counts negative. */
+
+void Sweep::addEdge( double x1, double y1, double x2, double y2, const int winding[ 2 ] )
+{
+    const bool forward = pointBefore( x1, y1, x2, y2 );
+    SweepEvent *le = newEvent( forward ? x1 : x2, forward ? y1 : y2, true );
+    SweepEvent *re = newEvent( forward ? x2 : x1, forward ? y2 : y1, false );
+    le->other = re;
+    re->other = le;
+    for( int p = 0; p < 2; ++p )
+        le->winding[ p ] = forward ? winding[ p ] : -winding[ p ];
+    addVertex( x1, y1 );
+    leftEvents.push_back( le );
+    queue.push( le );
+    queue.push( re );
+}
+
+void Sweep::addFaces( const Faces &faces, int polygon )
+{
+    int winding[ 2 ] = { 0, 0 };
+    winding[ polygon ] = 1;
+    for( const auto &face : faces ) {
+        const size_t pointCount = face.size();
+        if( pointCount < 3 )
+            continue;
+        for( size_t i = 0; i < pointCount; ++i ) {
+            const Vector2D &p1 = face[ i ];
+            const Vector2D &p2 = face[( i + 1 ) % pointCount ];
+            tolerance = std::max( tolerance, ( double ) std::max( fabs( p1.x ), fabs( p1.y )) * 1e-6 );
+            if( p1 == p2 )
+                continue;
+            addEdge( p1.x, p1.y, p2.x, p2.y, winding );
+        }
+    }
+}
+
+long long Sweep::cellKey( long long cx, long long cy ) const
+{
+    return cx * 73856093LL ^ cy * 19349663LL;
+}
+
+void Sweep::addVertex( double x, double y )
+{
+    if( !tolerance )
+        return;
+    vertices[ cellKey( floor( x / tolerance ), floor( y / tolerance ))].push_back( std::make_pair( x, y ));
+}
+
+bool Sweep::within( const SweepEvent *le, double x, double y ) const
+{
+    if( x == le->x && y == le->y )
+        return true;
+    if( x == le->other->x && y == le->other->y )
+        return true;
+    return pointBefore( le->x, le->y, x, y ) && pointBefore( x, y, le->other->x, le->other->y );
+}
+
+/* Intersections computed from different edge pairs rarely give the very
+   same coordinates for one geometric point, so new intersections reuse a
+   vertex already known within the tolerance, as long as it still splits
+   both edges in sweep order. */
+
+void Sweep::snap( double &x, double &y, const SweepEvent *a, const SweepEvent *b )
+{
+    if( !tolerance )
+        return;
+    const long long cx = floor( x / tolerance );
+    const long long cy = floor( y / tolerance );
+    for( long long ix = cx - 1; ix <= cx + 1; ++ix ) {
+        for( long long iy = cy - 1; iy <= cy + 1; ++iy ) {
+            auto found = vertices.find( cellKey( ix, iy ));
+            if( found == vertices.end() )
+                continue;
+            for( const auto &vertex : found->second ) {
+                if( fabs( vertex.first - x ) > tolerance || fabs( vertex.second - y ) > tolerance )
+                    continue;
+                if( !within( a, vertex.first, vertex.second ) || !within( b, vertex.first, vertex.second ))
+                    continue;
+                x = vertex.first;
+                y = vertex.second;
+                return;
+            }
+        }
+    }
+    addVertex( x, y );
+}
+
+bool Sweep::inside( const int wind[ 2 ] ) const
+{
+    const bool in0 = wind[ 0 ] != 0;
+    const bool in1 = wind[ 1 ] != 0;
+    switch( operation ) {
+    case FaceBooleans::BO_UNION:
+        return in0 || in1;
+    case FaceBooleans::BO_INTERSECTION:
+        return in0 && in1;
+    case FaceBooleans::BO_DIFFERENCE:
+        return in0 && !in1;
+    case FaceBooleans::BO_XOR:
+        return in0 != in1;
+    }
+    return false;
+}
+
+/* Winding numbers below the edge come from the edge under it in the status */
+
+void Sweep::computeFields( SweepEvent *le, SweepEvent *prev )
+{
+    for( int p = 0; p < 2; ++p ) {
+        le->windBelow[ p ] = prev ? prev->windAbove[ p ] : 0;
+        le->windAbove[ p ] = le->windBelow[ p ] + le->winding[ p ];
+    }
+    const bool below = inside( le->windBelow );
+    const bool above = inside( le->windAbove );
+    le->contributes = below != above;
+    le->insideAbove = above;
+}
+
+SweepEvent *Sweep::divide( SweepEvent *le, double x, double y )
+{
+    if( !pointBefore( le->x, le->y, x, y ) || !pointBefore( x, y, le->other->x, le->other->y ))
+        return nullptr;
+    SweepEvent *r = newEvent( x, y, false );
+    SweepEvent *l = newEvent( x, y, true );
+    for( int p = 0; p < 2; ++p )
+        l->winding[ p ] = le->winding[ p ];
+    l->other = le->other;
+    le->other->other = l;
+    r->other = le;
+    le->other = r;
+    leftEvents.push_back( l );
+    queue.push( r );
+    queue.push( l );
+    return l;
+}
+
+void Sweep::possibleIntersection( SweepEvent *a, SweepEvent *b )
+{
+    const double vax = a->other->x - a->x;
+    const double vay = a->other->y - a->y;
+    const double vbx = b->other->x - b->x;
+    const double vby = b->other->y - b->y;
+    const double ex = b->x - a->x;
+    const double ey = b->y - a->y;
+    const double kross = vax * vby - vay * vbx;
+    const double sqrLenA = vax * vax + vay * vay;
+    const double sqrLenB = vbx * vbx + vby * vby;
+    const double epsilon = 1e-12;
+
+    if( kross * kross > epsilon * sqrLenA * sqrLenB ) {
+        const double s = ( ex * vby - ey * vbx ) / kross;
+        if( s < 0 || s > 1 )
+            return;
+        const double t = ( ex * vay - ey * vax ) / kross;
+        if( t < 0 || t > 1 )
+            return;
+        double x = a->x + s * vax;
+        double y = a->y + s * vay;
+        if( s == 0 || s == 1 ) {
+            x = s ? a->other->x : a->x;
+            y = s ? a->other->y : a->y;
+        } else if( t == 0 || t == 1 ) {
+            x = t ? b->other->x : b->x;
+            y = t ? b->other->y : b->y;
+        } else {
+            if( !vax )
+                x = a->x;
+            else if( !vbx )
+                x = b->x;
+            if( !vay )
+                y = a->y;
+            else if( !vby )
+                y = b->y;
+            snap( x, y, a, b );
+        }
+        divide( a, x, y );
+        divide( b, x, y );
+        return;
+    }
+
+    const double sqrLenE = ex * ex + ey * ey;
+    const double kross2 = ex * vay - ey * vax;
+    if( kross2 * kross2 > epsilon * sqrLenA * sqrLenE )
+        return;
+
+    /* Collinear edges, split them until the overlapping parts are identical */
+
+    if( !pointBefore( a->x, a->y, b->other->x, b->other->y ) ||
+        !pointBefore( b->x, b->y, a->other->x, a->other->y ))
+        return;
+    SweepEvent *first = eventBefore( a, b ) ? a : b;
+    SweepEvent *second = first == a ? b : a;
+    const double fx = first->other->x;
+    const double fy = first->other->y;
+    const double sx = second->other->x;
+    const double sy = second->other->y;
+    SweepEvent *overlap = samePoint( a, b ) ? first : divide( first, second->x, second->y );
+    if( !overlap )
+        return;
+    if( pointBefore( sx, sy, fx, fy ))
+        divide( overlap, sx, sy );
+    else if( pointBefore( fx, fy, sx, sy ))
+        divide( second, fx, fy );
+}
+
+void Sweep::run( bool splitting )
+{
+    while( !queue.empty() ) {
+        SweepEvent *event = queue.top();
+        queue.pop();
+        if( event->left ) {
+            auto it = status.insert( event ).first;
+            event->position = it;
+            SweepEvent *prev = nullptr;
+            SweepEvent *next = nullptr;
+            if( it != status.begin() )
+                prev = *std::prev( it );
+            if( ++it != status.end() )
+                next = *it;
+            if( !splitting ) {
+                computeFields( event, prev );
+                continue;
+            }
+            if( next )
+                possibleIntersection( event, next );
+            if( prev )
+                possibleIntersection( prev, event );
+        } else {
+            SweepEvent *le = event->other;
+            auto it = le->position;
+            SweepEvent *prev = nullptr;
+            SweepEvent *next = nullptr;
+            if( it != status.begin() )
+                prev = *std::prev( it );
+            auto after = std::next( it );
+            if( after != status.end() )
+                next = *after;
+            status.erase( it );
+            if( splitting && prev && next )
+                possibleIntersection( prev, next );
+        }
+    }
+}
+
+void Sweep::split()
+{
+    run( true );
+}
+
+/* Coincident pieces are merged into one edge carrying the sum of their
+   windings, pieces which cancel each other out are dropped. */
+
+void Sweep::classify()
+{
+    typedef std::pair< std::pair< double, double >, std::pair< double, double >> EdgeKey;
+    std::map< EdgeKey, std::pair< int, int >> merged;
+    for( SweepEvent *le : leftEvents ) {
+        EdgeKey key( std::make_pair( le->x, le->y ), std::make_pair( le->other->x, le->other->y ));
+        auto &winding = merged[ key ];
+        winding.first += le->winding[ 0 ];
+        winding.second += le->winding[ 1 ];
+    }
+    events.clear();
+    leftEvents.clear();
+    status.clear();
+    vertices.clear();
+    tolerance = 0;
+    nextID = 0;
+    for( const auto &edge : merged ) {
+        if( !edge.second.first && !edge.second.second )
+            continue;
+        const int winding[ 2 ] = { edge.second.first, edge.second.second };
+        addEdge( edge.first.first.first, edge.first.first.second, edge.first.second.first, edge.first.second.second, winding );
+    }
+    run( false );
+}
+
+/* Chain the contributing edges into closed contours. Where several contours
+   touch in one point the sharpest right turn is taken, so every loop keeps
+   the result area on its right side. */
+
+Faces Sweep::connect()
+{
+    struct Edge
+    {
+        double                              x1;
+        double                              y1;
+        double                              x2;
+        double                              y2;
+        bool                                used;
+    };
+    std::vector< Edge > edges;
+    std::map< std::pair< double, double >, std::vector< size_t >> starts;
+    for( SweepEvent *le : leftEvents ) {
+        if( !le->contributes )
+            continue;
+        Edge edge;
+        if( le->insideAbove ) {
+            edge.x1 = le->other->x; edge.y1 = le->other->y;
+            edge.x2 = le->x; edge.y2 = le->y;
+        } else {
+            edge.x1 = le->x; edge.y1 = le->y;
+            edge.x2 = le->other->x; edge.y2 = le->other->y;
+        }
+        edge.used = false;
+        starts[ std::make_pair( edge.x1, edge.y1 )].push_back( edges.size() );
+        edges.push_back( edge );
+    }
+    Faces result;
+    for( size_t first = 0; first < edges.size(); ++first ) {
+        if( edges[ first ].used )
+            continue;
+        Face face;
+        size_t current = first;
+        for(;;) {
+            Edge &edge = edges[ current ];
+            edge.used = true;
+            face.push_back( Vector2D( edge.x1, edge.y1 ));
+            auto found = starts.find( std::make_pair( edge.x2, edge.y2 ));
+            if( found == starts.end() )
+                break;
+            const double rx = edge.x1 - edge.x2;
+            const double ry = edge.y1 - edge.y2;
+            double best = 0;
+            size_t bestID = edges.size();
+            for( auto id : found->second ) {
+                if( edges[ id ].used )
+                    continue;
+                const double ox = edges[ id ].x2 - edges[ id ].x1;
+                const double oy = edges[ id ].y2 - edges[ id ].y1;
+                double angle = atan2( rx * oy - ry * ox, rx * ox + ry * oy );
+                if( angle <= 0 )
+                    angle += 2 * M_PI;
+                if( bestID == edges.size() || angle < best ) {
+                    best = angle;
+                    bestID = id;
+                }
+            }
+            if( bestID == edges.size() )
+                break;
+            current = bestID;
+        }
+        if( face.size() > 2 )
+            result.push_back( face );
+    }
+    return result;
+}
+
+}
+
+Faces FaceBooleans::compute( const Faces &subject, const Faces &clip, BOOLOP operation )
+{
+    Sweep sweep( operation );
+    sweep.addFaces( subject, 0 );
+    sweep.addFaces( clip, 1 );
+    sweep.split();
+    sweep.classify();
+    return sweep.connect();
+}
+
+Faces FaceBooleans::unite( const Faces &subject, const Faces &clip )
+{
+    return compute( subject, clip, BO_UNION );
+}
+
+Faces FaceBooleans::intersect( const Faces &subject, const Faces &clip )
+{
+    return compute( subject, clip, BO_INTERSECTION );
+}
+
+Faces FaceBooleans::subtract( const Faces &subject, const Faces &clip )
+{
+    return compute( subject, clip, BO_DIFFERENCE );
+}
+
+Faces FaceBooleans::resolve( const Faces &faces )
+{
+    return compute( faces, Faces(), BO_UNION );
+}
+
+std::vector< std::pair< Face, std::vector< Face >>> FaceBooleans::group( const Faces &faces )
+{
+    std::vector< std::pair< Face, std::vector< Face >>> result;
+    std::vector< float > areas;
+    for( const auto &face : faces ) {
+        const float faceArea = area( face );
+        if( faceArea < 0 ) {
+            result.push_back( std::pair< Face, std::vector< Face >>( face, std::vector< Face >() ));
+            areas.push_back( -faceArea );
+        }
+    }
+    for( const auto &face : faces ) {
+        if( area( face ) < 0 )
+            continue;
+        int owner = -1;
+        for( size_t i = 0; i < result.size(); ++i ) {
+            if( !contains( result[ i ].first, face.front() ))
+                continue;
+            if( owner < 0 || areas[ i ] < areas[ owner ])
+                owner = i;
+        }
+        if( owner >= 0 )
+            result[ owner ].second.push_back( face );
+    }
+    return result;
+}
+
+float FaceBooleans::area( const Face &polygon )
+{
+    const size_t pointCount = polygon.size();
+    double sum = 0;
+    for( size_t i = 0; i < pointCount; ++i ) {
+        const Vector2D &p1 = polygon[ i ];
+        const Vector2D &p2 = polygon[( i + 1 ) % pointCount ];
+        sum += ( double ) p1.x * p2.y - ( double ) p2.x * p1.y;
+    }
+    return sum * 0.5;
+}
+
+bool FaceBooleans::contains( const Face &polygon, const Vector2D &point )
+{
+    bool in = false;
+    const size_t pointCount = polygon.size();
+    for( size_t i = 0, j = pointCount - 1; i < pointCount; j = i++ ) {
+        const Vector2D &pi = polygon[ i ];
+        const Vector2D &pj = polygon[ j ];
+        if(( pi.y > point.y ) != ( pj.y > point.y ) &&
+           point.x < ( pj.x - pi.x ) * ( point.y - pi.y ) / ( pj.y - pi.y ) + pi.x )
+            in = !in;
+    }
+    return in;
+}
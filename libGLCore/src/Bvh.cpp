@@ -0,0 +1,690 @@
+#include "Bvh.h"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+namespace {
+
+const int binCount = 12;
+const int maxLeafSize = 4;
+const int maxSahDepth = 48;
+const int parallelLimit = 4096;
+const int stackSize = 128;
+
+float axisValue( const Vector3D &vec, int axis )
+{
+    return axis == 0 ? vec.x : axis == 1 ? vec.y : vec.z;
+}
+
+/* Plain float box, the builder touches boxes millions of times */
+
+struct Bounds
+{
+    float                                   min[ 3 ];
+    float                                   max[ 3 ];
+    void reset()
+    {
+        for( int a = 0; a < 3; ++a ) {
+            min[ a ] = std::numeric_limits< float >::max();
+            max[ a ] = -std::numeric_limits< float >::max();
+        }
+    }
+    void grow( const float *point )
+    {
+        for( int a = 0; a < 3; ++a ) {
+            min[ a ] = std::min( min[ a ], point[ a ] );
+            max[ a ] = std::max( max[ a ], point[ a ] );
+        }
+    }
+    void grow( const Bounds &other )
+    {
+        for( int a = 0; a < 3; ++a ) {
+            min[ a ] = std::min( min[ a ], other.min[ a ] );
+            max[ a ] = std::max( max[ a ], other.max[ a ] );
+        }
+    }
+    float area() const
+    {
+        if( min[ 0 ] > max[ 0 ] )
+            return 0;
+        const float dx = max[ 0 ] - min[ 0 ];
+        const float dy = max[ 1 ] - min[ 1 ];
+        const float dz = max[ 2 ] - min[ 2 ];
+        return dx * dy + dy * dz + dz * dx;
+    }
+};
+
+/* Recursive binned SAH builder, the two halves of big nodes are built in parallel */
+
+class Builder
+{
+public:
+    Builder( BVH &tree, const std::vector< AABB > &boxes, ThreadPool *pool ) : tree( tree ), pool( pool )
+    {
+        prims.resize( boxes.size() );
+        centers.resize( boxes.size() * 3 );
+        for( size_t i = 0; i < boxes.size(); ++i ) {
+            const AABB &box = boxes[ i ];
+            Bounds &prim = prims[ i ];
+            prim.min[ 0 ] = box.min.x;
+            prim.min[ 1 ] = box.min.y;
+            prim.min[ 2 ] = box.min.z;
+            prim.max[ 0 ] = box.max.x;
+            prim.max[ 1 ] = box.max.y;
+            prim.max[ 2 ] = box.max.z;
+            for( int a = 0; a < 3; ++a )
+                centers[ 3 * i + a ] = ( prim.min[ a ] + prim.max[ a ] ) * 0.5f;
+        }
+        tree.items.resize( boxes.size() );
+        for( size_t i = 0; i < boxes.size(); ++i )
+            tree.items[ i ] = i;
+        tree.nodes.resize( 2 * boxes.size() - 1 );
+        used = 1;
+        subdivide( 0, 0, boxes.size(), 0 );
+        tree.nodes.resize( used );
+    }
+private:
+    struct Bin
+    {
+        Bounds                              box;
+        int                                 count;
+    };
+
+    void subdivide( int nodeIndex, int first, int count, int depth )
+    {
+        Bounds box;
+        Bounds centerBox;
+        box.reset();
+        centerBox.reset();
+        for( int i = first; i < first + count; ++i ) {
+            const int item = tree.items[ i ];
+            box.grow( prims[ item ] );
+            centerBox.grow( &centers[ 3 * item ] );
+        }
+        BVH::Node &node = tree.nodes[ nodeIndex ];
+        node.box.min = Vector3D( box.min[ 0 ], box.min[ 1 ], box.min[ 2 ] );
+        node.box.max = Vector3D( box.max[ 0 ], box.max[ 1 ], box.max[ 2 ] );
+        node.first = first;
+        node.count = count;
+        if( count <= 1 )
+            return;
+        Bin bins[ 3 ][ binCount ];
+        float scales[ 3 ];
+        for( int a = 0; a < 3; ++a ) {
+            const float extent = centerBox.max[ a ] - centerBox.min[ a ];
+            scales[ a ] = extent > 0 ? binCount / extent : 0;
+            for( auto &bin : bins[ a ] ) {
+                bin.box.reset();
+                bin.count = 0;
+            }
+        }
+        for( int i = first; i < first + count; ++i ) {
+            const int item = tree.items[ i ];
+            for( int a = 0; a < 3; ++a ) {
+                int b = std::min( binCount - 1, int(( centers[ 3 * item + a ] - centerBox.min[ a ] ) * scales[ a ] ));
+                bins[ a ][ b ].box.grow( prims[ item ] );
+                ++bins[ a ][ b ].count;
+            }
+        }
+        int axis = 0;
+        float split = 0;
+        float bestCost = std::numeric_limits< float >::max();
+        for( int a = 0; a < 3; ++a ) {
+            if( !scales[ a ] )
+                continue;
+            float rightArea[ binCount ];
+            int rightCount[ binCount ];
+            Bounds right;
+            right.reset();
+            int sum = 0;
+            for( int b = binCount - 1; b > 0; --b ) {
+                right.grow( bins[ a ][ b ].box );
+                sum += bins[ a ][ b ].count;
+                rightArea[ b ] = right.area();
+                rightCount[ b ] = sum;
+            }
+            Bounds left;
+            left.reset();
+            sum = 0;
+            for( int b = 0; b < binCount - 1; ++b ) {
+                left.grow( bins[ a ][ b ].box );
+                sum += bins[ a ][ b ].count;
+                if( !sum || !rightCount[ b + 1 ] )
+                    continue;
+                float cost = sum * left.area() + rightCount[ b + 1 ] * rightArea[ b + 1 ];
+                if( cost < bestCost ) {
+                    bestCost = cost;
+                    axis = a;
+                    split = centerBox.min[ a ] + ( b + 1 ) / scales[ a ];
+                }
+            }
+        }
+        const bool noSplit = bestCost == std::numeric_limits< float >::max();
+        if( count <= maxLeafSize && ( noSplit || bestCost >= count * box.area() ))
+            return;
+        int middle = first;
+        if( !noSplit && depth < maxSahDepth ) {
+            auto it = std::partition( tree.items.begin() + first, tree.items.begin() + first + count, [ this, axis, split ]( int item ) {
+                return centers[ 3 * item + axis ] < split;
+            } );
+            middle = it - tree.items.begin();
+        }
+        if( middle == first || middle == first + count ) {
+            float extent = -1;
+            for( int a = 0; a < 3; ++a ) {
+                if( centerBox.max[ a ] - centerBox.min[ a ] > extent ) {
+                    extent = centerBox.max[ a ] - centerBox.min[ a ];
+                    axis = a;
+                }
+            }
+            middle = first + count / 2;
+            std::nth_element( tree.items.begin() + first, tree.items.begin() + middle, tree.items.begin() + first + count, [ this, axis ]( int a, int b ) {
+                return centers[ 3 * a + axis ] < centers[ 3 * b + axis ];
+            } );
+        }
+        const int children = used.fetch_add( 2 );
+        node.first = children;
+        node.count = 0;
+        const int leftCount = middle - first;
+        if( pool && count > parallelLimit ) {
+            pool->parallelFor( 2, [ this, children, first, middle, leftCount, count, depth ]( size_t i ) {
+                if( i )
+                    subdivide( children + 1, middle, count - leftCount, depth + 1 );
+                else
+                    subdivide( children, first, leftCount, depth + 1 );
+            } );
+        } else {
+            subdivide( children, first, leftCount, depth + 1 );
+            subdivide( children + 1, middle, count - leftCount, depth + 1 );
+        }
+    }
+
+    BVH                                    &tree;
+    ThreadPool                             *pool;
+    std::vector< Bounds >                   prims;
+    std::vector< float >                    centers;
+    std::atomic< int >                      used;
+};
+
+/* Front to back traversal, visit is called with the items of the touched leaves
+   and may shorten the ray by lowering maxDistance */
+
+template< class Visit > void traverse( const BVH &tree, const Ray &ray, float &maxDistance, Visit visit )
+{
+    if( tree.isEmpty() )
+        return;
+    int stack[ stackSize ];
+    int top = 0;
+    stack[ top++ ] = 0;
+    while( top ) {
+        const BVH::Node &node = tree.nodes[ stack[ --top ]];
+        float distance;
+        if( !node.box.intersect( ray, maxDistance, distance ))
+            continue;
+        if( node.count ) {
+            for( int i = node.first; i < node.first + node.count; ++i )
+                visit( tree.items[ i ] );
+            continue;
+        }
+        float leftDistance = std::numeric_limits< float >::max();
+        float rightDistance = std::numeric_limits< float >::max();
+        bool left = tree.nodes[ node.first ].box.intersect( ray, maxDistance, leftDistance );
+        bool right = tree.nodes[ node.first + 1 ].box.intersect( ray, maxDistance, rightDistance );
+        if( left && right && leftDistance > rightDistance ) {
+            stack[ top++ ] = node.first;
+            stack[ top++ ] = node.first + 1;
+        } else {
+            if( right )
+                stack[ top++ ] = node.first + 1;
+            if( left )
+                stack[ top++ ] = node.first;
+        }
+    }
+}
+
+/* Nearest first traversal around a point */
+
+template< class Visit > void traverse( const BVH &tree, const Vector3D &point, float &maxDistance, Visit visit )
+{
+    if( tree.isEmpty() )
+        return;
+    int stack[ stackSize ];
+    int top = 0;
+    stack[ top++ ] = 0;
+    while( top ) {
+        const BVH::Node &node = tree.nodes[ stack[ --top ]];
+        if( node.box.distance( point ) > maxDistance )
+            continue;
+        if( node.count ) {
+            for( int i = node.first; i < node.first + node.count; ++i )
+                visit( tree.items[ i ] );
+            continue;
+        }
+        float leftDistance = tree.nodes[ node.first ].box.distance( point );
+        float rightDistance = tree.nodes[ node.first + 1 ].box.distance( point );
+        if( leftDistance > rightDistance ) {
+            stack[ top++ ] = node.first;
+            stack[ top++ ] = node.first + 1;
+        } else {
+            stack[ top++ ] = node.first + 1;
+            stack[ top++ ] = node.first;
+        }
+    }
+}
+
+/* Möller-Trumbore intersection, both sides of the triangle are hit */
+
+bool intersectTriangle( const Ray &ray, const Vector3D &v0, const Vector3D &v1, const Vector3D &v2, float &distance )
+{
+    const Vector3D edge1 = v1 - v0;
+    const Vector3D edge2 = v2 - v0;
+    const Vector3D p = Vector3D::cross( ray.direction, edge2 );
+    const float det = Vector3D::dot( edge1, p );
+    if( fabs( det ) < 1e-12f )
+        return false;
+    const float invDet = 1.f / det;
+    const Vector3D t = ray.origin - v0;
+    const float u = Vector3D::dot( t, p ) * invDet;
+    if( u < 0 || u > 1 )
+        return false;
+    const Vector3D q = Vector3D::cross( t, edge1 );
+    const float v = Vector3D::dot( ray.direction, q ) * invDet;
+    if( v < 0 || u + v > 1 )
+        return false;
+    distance = Vector3D::dot( edge2, q ) * invDet;
+    return distance >= 0;
+}
+
+/* Closest point of a triangle to a point */
+
+Vector3D closestOnTriangle( const Vector3D &p, const Vector3D &a, const Vector3D &b, const Vector3D &c )
+{
+    const Vector3D ab = b - a;
+    const Vector3D ac = c - a;
+    const Vector3D ap = p - a;
+    const float d1 = Vector3D::dot( ab, ap );
+    const float d2 = Vector3D::dot( ac, ap );
+    if( d1 <= 0 && d2 <= 0 )
+        return a;
+    const Vector3D bp = p - b;
+    const float d3 = Vector3D::dot( ab, bp );
+    const float d4 = Vector3D::dot( ac, bp );
+    if( d3 >= 0 && d4 <= d3 )
+        return b;
+    const float vc = d1 * d4 - d3 * d2;
+    if( vc <= 0 && d1 >= 0 && d3 <= 0 )
+        return a + ab * ( d1 / ( d1 - d3 ));
+    const Vector3D cp = p - c;
+    const float d5 = Vector3D::dot( ab, cp );
+    const float d6 = Vector3D::dot( ac, cp );
+    if( d6 >= 0 && d5 <= d6 )
+        return c;
+    const float vb = d5 * d2 - d1 * d6;
+    if( vb <= 0 && d2 >= 0 && d6 <= 0 )
+        return a + ac * ( d2 / ( d2 - d6 ));
+    const float va = d3 * d6 - d5 * d4;
+    if( va <= 0 && ( d4 - d3 ) >= 0 && ( d5 - d6 ) >= 0 )
+        return b + ( c - b ) * (( d4 - d3 ) / (( d4 - d3 ) + ( d5 - d6 )));
+    const float denom = 1.f / ( va + vb + vc );
+    return a + ab * ( vb * denom ) + ac * ( vc * denom );
+}
+
+}
+
+Ray::Ray() : direction( 0, 0, -1 )
+{
+}
+
+Ray::Ray( const Vector3D &origin, const Vector3D &direction ) : origin( origin ), direction( direction )
+{
+}
+
+Vector3D Ray::at( float distance ) const
+{
+    return origin + direction * distance;
+}
+
+Ray Ray::fromScreen( const Matrix &inverse, float x, float y )
+{
+    const Vector3D nearPoint = inverse.project( Vector3D( x, y, -1 ));
+    const Vector3D farPoint = inverse.project( Vector3D( x, y, 1 ));
+    return Ray( nearPoint, ( farPoint - nearPoint ).normalized() );
+}
+
+AABB::AABB() : min( std::numeric_limits< float >::max(), std::numeric_limits< float >::max(), std::numeric_limits< float >::max() ),
+    max( -std::numeric_limits< float >::max(), -std::numeric_limits< float >::max(), -std::numeric_limits< float >::max() )
+{
+}
+
+void AABB::grow( const Vector3D &point )
+{
+    min.x = std::min( min.x, point.x );
+    min.y = std::min( min.y, point.y );
+    min.z = std::min( min.z, point.z );
+    max.x = std::max( max.x, point.x );
+    max.y = std::max( max.y, point.y );
+    max.z = std::max( max.z, point.z );
+}
+
+void AABB::grow( const AABB &other )
+{
+    if( other.isEmpty() )
+        return;
+    grow( other.min );
+    grow( other.max );
+}
+
+bool AABB::isEmpty() const
+{
+    return min.x > max.x;
+}
+
+Vector3D AABB::center() const
+{
+    return ( min + max ) * 0.5f;
+}
+
+float AABB::area() const
+{
+    if( isEmpty() )
+        return 0;
+    const Vector3D size = max - min;
+    return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+float AABB::distance( const Vector3D &point ) const
+{
+    const float dx = std::max( std::max( min.x - point.x, point.x - max.x ), 0.f );
+    const float dy = std::max( std::max( min.y - point.y, point.y - max.y ), 0.f );
+    const float dz = std::max( std::max( min.z - point.z, point.z - max.z ), 0.f );
+    return sqrt( dx * dx + dy * dy + dz * dz );
+}
+
+bool AABB::contains( const Vector3D &point ) const
+{
+    return point.x >= min.x && point.x <= max.x && point.y >= min.y && point.y <= max.y && point.z >= min.z && point.z <= max.z;
+}
+
+bool AABB::intersect( const Ray &ray, float maxDistance, float &distance ) const
+{
+    float tmin = 0;
+    float tmax = maxDistance;
+    for( int a = 0; a < 3; ++a ) {
+        const float origin = axisValue( ray.origin, a );
+        const float direction = axisValue( ray.direction, a );
+        const float low = axisValue( min, a );
+        const float high = axisValue( max, a );
+        if( !direction ) {
+            if( origin < low || origin > high )
+                return false;
+            continue;
+        }
+        const float inv = 1.f / direction;
+        float t0 = ( low - origin ) * inv;
+        float t1 = ( high - origin ) * inv;
+        if( t0 > t1 )
+            std::swap( t0, t1 );
+        tmin = std::max( tmin, t0 );
+        tmax = std::min( tmax, t1 );
+        if( tmin > tmax )
+            return false;
+    }
+    distance = tmin;
+    return true;
+}
+
+AABB AABB::transformed( const Matrix &matrix ) const
+{
+    AABB result;
+    if( isEmpty() )
+        return result;
+    for( int corner = 0; corner < 8; ++corner )
+        result.grow( matrix * Vector3D( corner & 1 ? max.x : min.x, corner & 2 ? max.y : min.y, corner & 4 ? max.z : min.z ));
+    return result;
+}
+
+RayHit::RayHit() : distance( std::numeric_limits< float >::max() ), triangle( -1 ), instance( -1 )
+{
+}
+
+void BVH::build( const std::vector< AABB > &boxes, ThreadPool *pool )
+{
+    clear();
+    if( boxes.empty() )
+        return;
+    Builder builder( *this, boxes, pool );
+}
+
+/* Updates the boxes of the nodes from the leaves up, the children of a node
+   always come after it */
+
+void BVH::refit( const std::vector< AABB > &boxes )
+{
+    for( int i = int( nodes.size()) - 1; i >= 0; --i ) {
+        Node &node = nodes[ i ];
+        node.box = AABB();
+        if( node.count ) {
+            for( int item = node.first; item < node.first + node.count; ++item )
+                node.box.grow( boxes[ items[ item ]] );
+        } else {
+            node.box.grow( nodes[ node.first ].box );
+            node.box.grow( nodes[ node.first + 1 ].box );
+        }
+    }
+}
+
+void BVH::clear()
+{
+    nodes.clear();
+    items.clear();
+}
+
+bool BVH::isEmpty() const
+{
+    return nodes.empty();
+}
+
+const AABB &BVH::bounds() const
+{
+    static const AABB empty;
+    return nodes.empty() ? empty : nodes.front().box;
+}
+
+MeshBVH::MeshBVH() : mesh( nullptr )
+{
+}
+
+void MeshBVH::build( const Mesh &mesh, ThreadPool *pool )
+{
+    this->mesh = &mesh;
+    std::vector< AABB > boxes( mesh.mIndices.size() / 3 );
+    for( size_t i = 0; i < boxes.size(); ++i ) {
+        for( int corner = 0; corner < 3; ++corner )
+            boxes[ i ].grow( mesh.mVertices[ mesh.mIndices[ 3 * i + corner ]] );
+    }
+    tree.build( boxes, pool );
+}
+
+bool MeshBVH::intersect( const Ray &ray, RayHit &hit ) const
+{
+    bool found = false;
+    float maxDistance = hit.distance;
+    traverse( tree, ray, maxDistance, [ & ]( int triangle ) {
+        const uint *index = &mesh->mIndices[ 3 * triangle ];
+        float distance;
+        if( intersectTriangle( ray, mesh->mVertices[ index[ 0 ]], mesh->mVertices[ index[ 1 ]], mesh->mVertices[ index[ 2 ]], distance ) && distance < maxDistance ) {
+            maxDistance = distance;
+            hit.triangle = triangle;
+            found = true;
+        }
+    } );
+    if( found ) {
+        hit.distance = maxDistance;
+        hit.point = ray.at( maxDistance );
+    }
+    return found;
+}
+
+bool MeshBVH::nearest( const Vector3D &point, float maxDistance, RayHit &hit ) const
+{
+    bool found = false;
+    maxDistance = std::min( maxDistance, hit.distance );
+    traverse( tree, point, maxDistance, [ & ]( int triangle ) {
+        const uint *index = &mesh->mIndices[ 3 * triangle ];
+        Vector3D closest = closestOnTriangle( point, mesh->mVertices[ index[ 0 ]], mesh->mVertices[ index[ 1 ]], mesh->mVertices[ index[ 2 ]] );
+        float distance = ( closest - point ).length();
+        if( distance <= maxDistance ) {
+            maxDistance = distance;
+            hit.triangle = triangle;
+            hit.point = closest;
+            found = true;
+        }
+    } );
+    if( found )
+        hit.distance = maxDistance;
+    return found;
+}
+
+SceneBVH::SceneBVH() : retired( 0 ), covered( 0 )
+{
+}
+
+void SceneBVH::clear()
+{
+    instances.clear();
+    tree.clear();
+    retired = 0;
+    covered = 0;
+}
+
+size_t SceneBVH::size() const
+{
+    return instances.size() - retired;
+}
+
+int SceneBVH::addInstance( const MeshBVH *bvh, const Matrix &transform )
+{
+    Instance instance;
+    instance.bvh = bvh;
+    instances.push_back( instance );
+    place( size() - 1, transform );
+    return size() - 1;
+}
+
+/* The longest axis of the inverse bounds how much a distance grows in the instance */
+
+void SceneBVH::place( int index, const Matrix &transform )
+{
+    Instance &instance = instances[ retired + index ];
+    instance.transform = transform;
+    instance.inverse = transform.inverted();
+    const Vector3D origin = instance.inverse * Vector3D( 0, 0, 0 );
+    instance.stretch = std::max( std::max(( instance.inverse * Vector3D( 1, 0, 0 ) - origin ).length(),
+                                          ( instance.inverse * Vector3D( 0, 1, 0 ) - origin ).length()),
+                                          ( instance.inverse * Vector3D( 0, 0, 1 ) - origin ).length());
+}
+
+void SceneBVH::retire( size_t count )
+{
+    retired += count;
+}
+
+static AABB instanceBox( const SceneBVH::Instance &instance )
+{
+    return instance.bvh->tree.bounds().transformed( instance.transform );
+}
+
+/* Retired instances get empty boxes, a refit leaves them out of the nodes */
+
+static std::vector< AABB > instanceBoxes( const std::vector< SceneBVH::Instance > &instances, size_t retired )
+{
+    std::vector< AABB > boxes( instances.size() );
+    for( size_t i = retired; i < instances.size(); ++i )
+        boxes[ i ] = instanceBox( instances[ i ] );
+    return boxes;
+}
+
+void SceneBVH::build( ThreadPool *pool )
+{
+    instances.erase( instances.begin(), instances.begin() + retired );
+    retired = 0;
+    covered = instances.size();
+    tree.build( instanceBoxes( instances, 0 ), pool );
+}
+
+/* The tree is built again once more than half of it is retired or too many
+   instances are tested outside of it */
+
+void SceneBVH::update( ThreadPool *pool )
+{
+    if( instances.size() - covered > pendingLimit || retired > covered / 2 )
+        build( pool );
+}
+
+void SceneBVH::refit()
+{
+    tree.refit( instanceBoxes( instances, retired ));
+}
+
+bool SceneBVH::intersect( const Ray &ray, RayHit &hit ) const
+{
+    bool found = false;
+    float maxDistance = hit.distance;
+    auto visit = [ & ]( int index ) {
+        if( size_t( index ) < retired )
+            return;
+        const Instance &instance = instances[ index ];
+        const Vector3D origin = instance.inverse * ray.origin;
+        Ray local( origin, instance.inverse * ( ray.origin + ray.direction ) - origin );
+        RayHit localHit;
+        localHit.distance = maxDistance;
+        if( instance.bvh->intersect( local, localHit )) {
+            maxDistance = localHit.distance;
+            hit.triangle = localHit.triangle;
+            hit.instance = index - retired;
+            found = true;
+        }
+    };
+    traverse( tree, ray, maxDistance, visit );
+    for( size_t index = std::max( covered, retired ); index < instances.size(); ++index ) {
+        float distance;
+        if( instanceBox( instances[ index ] ).intersect( ray, maxDistance, distance ))
+            visit( index );
+    }
+    if( found ) {
+        hit.distance = maxDistance;
+        hit.point = ray.at( maxDistance );
+    }
+    return found;
+}
+
+bool SceneBVH::nearest( const Vector3D &point, float maxDistance, RayHit &hit ) const
+{
+    bool found = false;
+    maxDistance = std::min( maxDistance, hit.distance );
+    auto visit = [ & ]( int index ) {
+        if( size_t( index ) < retired )
+            return;
+        const Instance &instance = instances[ index ];
+        RayHit localHit;
+        if( instance.bvh->nearest( instance.inverse * point, maxDistance * instance.stretch, localHit )) {
+            const Vector3D closest = instance.transform * localHit.point;
+            const float distance = ( closest - point ).length();
+            if( distance <= maxDistance ) {
+                maxDistance = distance;
+                hit.triangle = localHit.triangle;
+                hit.instance = index - retired;
+                hit.point = closest;
+                found = true;
+            }
+        }
+    };
+    traverse( tree, point, maxDistance, visit );
+    for( size_t index = std::max( covered, retired ); index < instances.size(); ++index ) {
+        if( instanceBox( instances[ index ] ).distance( point ) <= maxDistance )
+            visit( index );
+    }
+    if( found )
+        hit.distance = maxDistance;
+    return found;
+}
@@ -2,8 +2,13 @@
 #include <stdlib.h>
 #include <fcntl.h>
 #include <sys/stat.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
 #include <unistd.h>
 #include <cctype>
+#include <algorithm>
+#include <atomic>
 
 int log_file_id;
 
@@ -19,11 +24,69 @@ bool FileBuffer::openAndRead( const char *filename ) {
     fstat( fd, &st );
     size = st.st_size;
     buffer = std::shared_ptr<unsigned char[]>( new unsigned char[ size ]);
-    size_t readBytes = read( fd, buffer.get(), size );
+    ssize_t readBytes = read( fd, buffer.get(), size );
     close( fd );
     return readBytes == size;
 }
 
+MappedFile::MappedFile( const char *filename ) {
+    size = 0;
+    data = nullptr;
+    if( filename )
+        open( filename );
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+/* Without mmap, on Windows, the file is read into a buffer of its own */
+
+bool MappedFile::open( const char *filename ) {
+    close();
+#ifdef _WIN32
+    int fd = ::open( filename, O_RDONLY | O_BINARY );
+#else
+    int fd = ::open( filename, O_RDONLY );
+#endif
+    if( fd < 0 )
+        return false;
+    struct stat st;
+    if( fstat( fd, &st ) || !st.st_size ) {
+        ::close( fd );
+        return false;
+    }
+#ifdef _WIN32
+    unsigned char *buffer = new unsigned char[ st.st_size ];
+    ssize_t readBytes = read( fd, buffer, st.st_size );
+    ::close( fd );
+    if( readBytes != st.st_size ) {
+        delete [] buffer;
+        return false;
+    }
+    data = buffer;
+#else
+    void *mapped = mmap( nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    ::close( fd );
+    if( mapped == MAP_FAILED )
+        return false;
+    data = ( const unsigned char* ) mapped;
+#endif
+    size = st.st_size;
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    delete [] data;
+#else
+    if( data )
+        munmap(( void* ) data, size );
+#endif
+    data = nullptr;
+    size = 0;
+}
+
 corestring::corestring() : std::string()
 {
 }
@@ -125,6 +188,101 @@ bool log_message( const char *format, ... )
   return size == output.length();
 }
 
+ThreadPool::ThreadPool( int workers ) : stopping( false )
+{
+    if( workers <= 0 )
+        workers = std::thread::hardware_concurrency();
+    for( int i = 1; i < workers; ++i )
+        this->workers.push_back( std::thread( &ThreadPool::work, this ));
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::unique_lock< std::mutex > lock( mutex );
+        stopping = true;
+    }
+    wake.notify_all();
+    for( auto &worker : workers )
+        worker.join();
+}
+
+int ThreadPool::size() const
+{
+    return workers.size() + 1;
+}
+
+void ThreadPool::run( const std::function< void() > &task )
+{
+    if( workers.empty() ) {
+        task();
+        return;
+    }
+    {
+        std::unique_lock< std::mutex > lock( mutex );
+        tasks.push_back( task );
+    }
+    wake.notify_one();
+}
+
+void ThreadPool::work()
+{
+    for(;;) {
+        std::function< void() > task;
+        {
+            std::unique_lock< std::mutex > lock( mutex );
+            wake.wait( lock, [ this ] { return stopping || !tasks.empty(); } );
+            if( tasks.empty() )
+                return;
+            task = tasks.front();
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor( size_t count, const std::function< void( size_t ) > &body )
+{
+    if( workers.empty() || count < 2 ) {
+        for( size_t i = 0; i < count; ++i )
+            body( i );
+        return;
+    }
+    struct Job
+    {
+        std::atomic< size_t >               next;
+        std::atomic< size_t >               finished;
+        std::mutex                          mutex;
+        std::condition_variable             done;
+    };
+    auto job = std::make_shared< Job >();
+    job->next = 0;
+    job->finished = 0;
+    const std::function< void( size_t ) > *loop = &body;
+    auto task = [ job, count, loop ] {
+        size_t i;
+        while(( i = job->next++ ) < count ) {
+            ( *loop )( i );
+            if( ++job->finished == count ) {
+                std::unique_lock< std::mutex > lock( job->mutex );
+                job->done.notify_all();
+            }
+        }
+    };
+    const size_t helpers = std::min( workers.size(), count - 1 );
+    for( size_t i = 0; i < helpers; ++i )
+        run( task );
+    task();
+    std::unique_lock< std::mutex > lock( job->mutex );
+    job->done.wait( lock, [ job, count ] { return job->finished == count; } );
+}
+
+ThreadPool &ThreadPool::global()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
 int get_rnd( int min, int max ) {
     static unsigned int hash = clock();
     hash *= 0x372ce9b9;
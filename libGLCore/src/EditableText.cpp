@@ -0,0 +1,221 @@
+#include "EditableText.h"
+#include "Utf8.h"
+#include <algorithm>
+
+EditableText::Line::Line( const string &text ) : text( text ), incoming( -2 ), outgoing( -1 ), y( 0 ),
+    firstVertex( 0 ), vertexCount( 0 ), vertexCapacity( 0 ), firstIndex( 0 ), indexCount( 0 ), indexCapacity( 0 ), dirty( true )
+{
+}
+
+EditableText::EditableText( VectorFont &font, const string &text ) : font( font ), unusedVertices( 0 ), meshVersion( font.meshVersion )
+{
+    setText( text );
+}
+
+void EditableText::setText( const string &text )
+{
+    lines.clear();
+    mesh.clear();
+    unusedVertices = 0;
+    size_t begin = 0;
+    for( ;; ) {
+        size_t end = text.find( '\n', begin );
+        if( end == string::npos ) {
+            lines.push_back( Line( text.substr( begin )));
+            break;
+        }
+        lines.push_back( Line( text.substr( begin, end - begin )));
+        begin = end + 1;
+    }
+}
+
+void EditableText::setLine( size_t line, const string &text )
+{
+    if( lines[ line ].text == text )
+        return;
+    lines[ line ].text = text;
+    lines[ line ].dirty = true;
+}
+
+void EditableText::insertLine( size_t line, const string &text )
+{
+    lines.insert( lines.begin() + line, Line( text ));
+}
+
+void EditableText::eraseLine( size_t line )
+{
+    release( lines[ line ] );
+    lines.erase( lines.begin() + line );
+}
+
+string EditableText::text() const
+{
+    string text;
+    for( size_t i = 0; i < lines.size(); ++i ) {
+        if( i )
+            text += '\n';
+        text += lines[ i ].text;
+    }
+    return text;
+}
+
+/* A line is laid out again when its text changed or when the glyph before it
+   did, since the kerning carries over line breaks. After the font replaced
+   meshes, a restyle may have changed the kerning as well */
+
+size_t EditableText::update()
+{
+    vertexPatches.clear();
+    indexPatches.clear();
+    const uint64_t version = font.meshVersion;
+    const bool swapped = version != meshVersion;
+    meshVersion = version;
+    size_t relaid = 0;
+    int previous = -1;
+    for( size_t number = 0; number < lines.size(); ++number ) {
+        Line &line = lines[ number ];
+        const float y = -3.0f * number;
+        if( line.dirty || line.incoming != previous || ( swapped && replaced( line ))) {
+            relayout( line, number, previous );
+            remesh( line );
+            ++relaid;
+        } else if( line.y != y ) {
+            move( line, number, y );
+        }
+        previous = line.outgoing;
+    }
+    if( unusedVertices > mesh.mVertices.size() / 2 )
+        compact();
+    return relaid;
+}
+
+void EditableText::relayout( Line &line, size_t number, int previous )
+{
+    std::vector< char32_t > codepoints;
+    Utf8Decoder::decode( line.text, codepoints );
+    line.placements.clear();
+    line.incoming = previous;
+    line.y = -3.0f * number;
+    font.layoutLine( codepoints.data(), codepoints.data() + codepoints.size(), number, line.y, previous, line.placements );
+    line.outgoing = previous;
+    line.dirty = false;
+}
+
+bool EditableText::replaced( const Line &line ) const
+{
+    for( size_t i = 0; i < line.placements.size(); ++i ) {
+        const int glyph = line.placements[ i ].glyph;
+        if( size_t( glyph ) >= font.glyphs.size() || font.glyphMesh( glyph ) != line.meshes[ i ] )
+            return true;
+    }
+    return false;
+}
+
+void EditableText::remesh( Line &line )
+{
+    size_t vertices = 0;
+    size_t indices = 0;
+    line.meshes.resize( line.placements.size() );
+    for( size_t i = 0; i < line.placements.size(); ++i ) {
+        line.meshes[ i ] = font.glyphMesh( line.placements[ i ].glyph );
+        const Triangles &glyph = *line.meshes[ i ];
+        vertices += glyph.mVertices.size();
+        indices += glyph.mIndices.size();
+    }
+    if( vertices > line.vertexCapacity || indices > line.indexCapacity ) {
+        release( line );
+        line.vertexCapacity = vertices + vertices / 2;
+        line.indexCapacity = indices + indices / 2;
+        line.firstVertex = mesh.mVertices.size();
+        line.firstIndex = mesh.mIndices.size();
+        mesh.mVertices.resize( line.firstVertex + line.vertexCapacity );
+        mesh.mNormals.resize( line.firstVertex + line.vertexCapacity );
+        mesh.mIndices.resize( line.firstIndex + line.indexCapacity );
+    }
+    Vector3D *vertex = mesh.mVertices.data() + line.firstVertex;
+    Vector3D *normal = mesh.mNormals.data() + line.firstVertex;
+    uint *index = mesh.mIndices.data() + line.firstIndex;
+    uint base = line.firstVertex;
+    for( size_t i = 0; i < line.placements.size(); ++i ) {
+        const VectorFont::Placement &placement = line.placements[ i ];
+        const Triangles &glyph = *line.meshes[ i ];
+        const Vector3D shift( placement.x, placement.y, 0 );
+        for( const auto &source : glyph.mVertices )
+            *vertex++ = source + shift;
+        normal = std::copy( glyph.mNormals.begin(), glyph.mNormals.end(), normal );
+        for( auto source : glyph.mIndices )
+            *index++ = base + source;
+        base += glyph.mVertices.size();
+    }
+    std::fill( index, mesh.mIndices.data() + line.firstIndex + line.indexCapacity, uint( line.firstVertex ));
+    line.vertexCount = vertices;
+    line.indexCount = indices;
+    Range vertexRange = { line.firstVertex, vertices };
+    Range indexRange = { line.firstIndex, line.indexCapacity };
+    vertexPatches.push_back( vertexRange );
+    indexPatches.push_back( indexRange );
+}
+
+/* The slot stays in the mesh as degenerate triangles until compaction */
+
+void EditableText::release( Line &line )
+{
+    if( !line.indexCapacity && !line.vertexCapacity )
+        return;
+    std::fill( mesh.mIndices.begin() + line.firstIndex, mesh.mIndices.begin() + line.firstIndex + line.indexCapacity, uint( line.firstVertex ));
+    Range indexRange = { line.firstIndex, line.indexCapacity };
+    indexPatches.push_back( indexRange );
+    unusedVertices += line.vertexCapacity;
+    line.vertexCount = line.vertexCapacity = 0;
+    line.indexCount = line.indexCapacity = 0;
+}
+
+void EditableText::move( Line &line, size_t number, float y )
+{
+    const Vector3D shift( 0, y - line.y, 0 );
+    for( size_t i = line.firstVertex; i < line.firstVertex + line.vertexCount; ++i )
+        mesh.mVertices[ i ] = mesh.mVertices[ i ] + shift;
+    for( auto &placement : line.placements ) {
+        placement.y = y;
+        placement.line = number;
+    }
+    line.y = y;
+    Range vertexRange = { line.firstVertex, line.vertexCount };
+    vertexPatches.push_back( vertexRange );
+}
+
+/* Drops the released slots, the lines keep their slack */
+
+void EditableText::compact()
+{
+    Triangles packed;
+    size_t vertices = 0;
+    size_t indices = 0;
+    for( const auto &line : lines ) {
+        vertices += line.vertexCapacity;
+        indices += line.indexCapacity;
+    }
+    packed.mVertices.resize( vertices );
+    packed.mNormals.resize( vertices );
+    packed.mIndices.resize( indices );
+    size_t firstVertex = 0;
+    size_t firstIndex = 0;
+    for( auto &line : lines ) {
+        std::copy( mesh.mVertices.begin() + line.firstVertex, mesh.mVertices.begin() + line.firstVertex + line.vertexCapacity, packed.mVertices.begin() + firstVertex );
+        std::copy( mesh.mNormals.begin() + line.firstVertex, mesh.mNormals.begin() + line.firstVertex + line.vertexCapacity, packed.mNormals.begin() + firstVertex );
+        for( size_t i = 0; i < line.indexCapacity; ++i )
+            packed.mIndices[ firstIndex + i ] = mesh.mIndices[ line.firstIndex + i ] - line.firstVertex + firstVertex;
+        line.firstVertex = firstVertex;
+        line.firstIndex = firstIndex;
+        firstVertex += line.vertexCapacity;
+        firstIndex += line.indexCapacity;
+    }
+    mesh = std::move( packed );
+    unusedVertices = 0;
+    vertexPatches.clear();
+    indexPatches.clear();
+    Range vertexRange = { 0, mesh.mVertices.size() };
+    Range indexRange = { 0, mesh.mIndices.size() };
+    vertexPatches.push_back( vertexRange );
+    indexPatches.push_back( indexRange );
+}
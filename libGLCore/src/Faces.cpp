@@ -134,12 +134,22 @@ Faces::Faces( const Face &polygon )
     push_back( polygon );
 }
 
-Faces::Faces(vector<Face> &faces) :  vector<Face>( faces )
+Faces::Faces( Face &&polygon )
+{
+    push_back( std::move( polygon ));
+}
+
+Faces::Faces( const vector<Face> &faces ) : vector<Face>( faces )
 {
 
 }
 
-void Faces::shift( Vector2D shift )
+Faces::Faces( vector<Face> &&faces ) : vector<Face>( std::move( faces ))
+{
+
+}
+
+void Faces::shift( const Vector2D &shift )
 {
     for( auto &face : *this ) {
         face.shift( shift );
@@ -150,15 +160,18 @@ BBoxFace::BBoxFace()
 {
 }
 
-BBoxFace::BBoxFace( const BBoxFace &src ) : Face( src )
+BBoxFace::BBoxFace( const BBoxFace &src ) : Face( src ), minx( src.minx ), maxx( src.maxx ), miny( src.miny ), maxy( src.maxy )
+{
+}
+
+BBoxFace::BBoxFace( BBoxFace &&src ) : Face( std::move( src )), minx( src.minx ), maxx( src.maxx ), miny( src.miny ), maxy( src.maxy )
 {
-    operator = ( src );
 }
 
 BBoxFace::BBoxFace( const Face &src )
 {
     bool first = true;
-    for( auto pnt : src ) {
+    for( const auto &pnt : src ) {
         if( first ) {
             minx = maxx = pnt.x;
             miny = maxy = pnt.y;
@@ -178,7 +191,7 @@ BBoxFace::BBoxFace( const Face &src )
 
 BBoxFace &BBoxFace::operator = ( const BBoxFace &src )
 {
-    *(Face*)this = (Face)src;
+    Face::operator = ( src );
     minx = src.minx;
     maxx = src.maxx;
     miny = src.miny;
@@ -186,7 +199,17 @@ BBoxFace &BBoxFace::operator = ( const BBoxFace &src )
     return *this;
 }
 
-void BBoxFace::addPoint( const Vector2D pnt )
+BBoxFace &BBoxFace::operator = ( BBoxFace &&src )
+{
+    Face::operator = ( std::move( src ));
+    minx = src.minx;
+    maxx = src.maxx;
+    miny = src.miny;
+    maxy = src.maxy;
+    return *this;
+}
+
+void BBoxFace::addPoint( const Vector2D &pnt )
 {
     if( !size() ) {
         minx = maxx = pnt.x;
@@ -201,7 +224,7 @@ void BBoxFace::addPoint( const Vector2D pnt )
         if( maxy < pnt.y )
             maxy = pnt.y;
     }
-    insert( begin(), pnt );
+    push_back( pnt );
 }
 
 int BBoxFace::checkRelation( const BBoxFace &other )
@@ -223,6 +246,12 @@ int BBoxFace::checkRelation( const BBoxFace &other )
     return 0;
 }
 
+bool BBoxFace::overlaps( const BBoxFace &other ) const
+{
+    return other.minx < maxx && other.maxx > minx &&
+           other.miny < maxy && other.maxy > miny;
+}
+
 void BBoxFace::grow( const BBoxFace &other )
 {
     if( minx > other.minx )
@@ -243,7 +272,7 @@ void BBoxFace::setBox( const BBoxFace &other )
     maxy = other.maxy;
 }
 
-Face FaceGeneators::grow( const Face polygon, float width )
+Face FaceGeneators::grow( const Face &polygon, float width )
 {
     Tangents tangents = generateTangents( polygon );
     const int pointCount = polygon.size();
@@ -281,7 +310,7 @@ Face FaceGeneators::roundedRect( float width, float height, float radius, int st
     return polygon;
 }
 
-Face FaceGeneators::drill( const Face polygon, const Faces holes )
+Face FaceGeneators::drill( const Face &polygon, const Faces &holes )
 {
     if( !holes.size() )
         return polygon;
@@ -301,20 +330,17 @@ Face FaceGeneators::drill( const Face polygon, const Faces holes )
     else
         faces.insert( std::pair<int, Face>( 0, polygon ));
     int faceid = 1;
-    for( auto face : holes ) {
+    for( const auto &face : holes ) {
         if( FaceGeneators::checkOrientation( face ) )
             faces.insert( std::pair<int, Face>( faceid++, face ));
         else
             faces.insert( std::pair<int, Face>( faceid++, face.reversed() ));
     }
-    for( auto newFace : faces ) {
-        std::pair<int, Face> face;
-        face.first = newFace.first;
-        face.second = newFace.second;
+    for( const auto &face : faces ) {
         facepointid = 0;
         pointCounts.insert( std::pair<int, size_t>( face.first, face.second.size() ));
         first = true;
-        for( auto item : face.second ) {
+        for( const auto &item : face.second ) {
             Point point;
             point.faceID = face.first;
             point.point = item;
@@ -341,17 +367,17 @@ Face FaceGeneators::drill( const Face polygon, const Faces holes )
         allFaces.push_back( Line2D( l, p ));
     }
     bool next = false;
-    for( auto face : faces ) {
+    for( const auto &face : faces ) {
         if( 0 == face.first )
             continue;
         next = false;
-        for( auto otherface : faces ) {
+        for( const auto &otherface : faces ) {
             if( otherface.first == face.first )
                 continue;
             Point p1;
             p1.faceID = otherface.first;
             int otherID = 0;
-            for( auto otherpoint : otherface.second ) {
+            for( const auto &otherpoint : otherface.second ) {
                 p1.faceID = 0;
                 p1.pointID = otherID++;
                 p1.point = otherpoint;
@@ -360,7 +386,7 @@ Face FaceGeneators::drill( const Face polygon, const Faces holes )
                 Point p2;
                 p2.faceID = face.first;
                 int faceID = 0;
-                for( auto point : face.second ) {
+                for( const auto &point : face.second ) {
                     p2.pointID = faceID++;
                     p2.point = point;
                     if( usedPoints.find( p2 ) != usedPoints.end() )
@@ -442,7 +468,7 @@ Face FaceGeneators::drill( const Face polygon, const Faces holes )
     return result;
 }
 
-Tangents FaceGeneators::generateTangents( const Face polygon )
+Tangents FaceGeneators::generateTangents( const Face &polygon )
 {
     const int pointCount = polygon.size();
 
@@ -470,6 +470,7 @@ Program::Program() {
     mUPos = -1;
     mPositionAttribute = -1;
     mNormalAttribute = -1;
+    mTexCoordAttribute = -1;
 }
 
 Program::Program( const Program &other ) {
@@ -534,6 +535,7 @@ void Program::useProgram() {
     glUseProgram( mProgram );
     mPositionAttribute = glGetAttribLocation( mProgram, "posAttr" );
     mNormalAttribute = glGetAttribLocation( mProgram, "normalAttr" );
+    mTexCoordAttribute = glGetAttribLocation( mProgram, "texAttr" );
 }
 
 GLuint Program::getProgram() const {
@@ -559,6 +561,13 @@ void Program::enableNormal( bool enable ) {
         glDisableVertexAttribArray( mNormalAttribute );
 }
 
+void Program::enableTexCoord( bool enable ) {
+    if( enable )
+        glEnableVertexAttribArray( mTexCoordAttribute );
+    else
+        glDisableVertexAttribArray( mTexCoordAttribute );
+}
+
 void Program::setUniform( const char *value, const float f1 ) {
     mUPos = glGetUniformLocation( mProgram, value );
     glUniform1f( mUPos, f1 );
@@ -598,3 +607,10 @@ void Program::drawMesh( const Mesh &mesh ) const
     glVertexAttribPointer( mNormalAttribute, 3, GL_FLOAT, GL_FALSE, 0, mesh.mNormals.data() );
     glDrawElements( GL_TRIANGLES, mesh.mIndices.size(), GL_UNSIGNED_INT, mesh.mIndices.data() );
 }
+
+void Program::drawMesh( const TexturedMesh &mesh ) const
+{
+    glVertexAttribPointer( mPositionAttribute, 3, GL_FLOAT, GL_FALSE, 0, mesh.mVertices.data() );
+    glVertexAttribPointer( mTexCoordAttribute, 2, GL_FLOAT, GL_FALSE, 0, mesh.mTexCoords.data() );
+    glDrawElements( GL_TRIANGLES, mesh.mIndices.size(), GL_UNSIGNED_INT, mesh.mIndices.data() );
+}
@@ -0,0 +1,180 @@
+#include "GlyphCache.h"
+
+namespace {
+
+size_t meshBytes( const Triangles &mesh )
+{
+    return sizeof( Triangles ) + ( mesh.mVertices.size() + mesh.mNormals.size() ) * sizeof( Vector3D ) + mesh.mIndices.size() * sizeof( uint );
+}
+
+} // namespace
+
+GlyphCache::GlyphCache( size_t budget ) : budget( budget )
+{
+    stats = Counters();
+}
+
+/* Added fonts may outlive the cache, they extrude their meshes themselves
+   from then on */
+
+GlyphCache::~GlyphCache()
+{
+    for( auto &entry : fonts )
+        entry->font->meshSource = nullptr;
+}
+
+/* Without kept meshes Init only takes the outlines, glyphs and kerning
+   pairs are filled on first use */
+
+int GlyphCache::addFont( const std::map< long, std::vector<std::vector<std::pair<double,double>>>> &font_src, float grow, float depth, float bevel, int roundStep )
+{
+    std::unique_ptr< Font > entry( new Font );
+    entry->owned.reset( new VectorFont );
+    entry->font = entry->owned.get();
+    entry->font->keepMeshes = false;
+    entry->font->lazy = true;
+    entry->font->Init( font_src, grow, depth, bevel, roundStep );
+    return attach( std::move( entry ));
+}
+
+int GlyphCache::addFont( VectorFont &font )
+{
+    std::unique_ptr< Font > entry( new Font );
+    entry->font = &font;
+    return attach( std::move( entry ));
+}
+
+int GlyphCache::attach( std::unique_ptr< Font > entry )
+{
+    entry->slots.resize( entry->font->glyphs.size() );
+    for( auto &slot : entry->slots )
+        slot.bytes = 0;
+    std::unique_lock< std::mutex > lock( mutex );
+    const int index = fonts.size();
+    entry->font->meshSource = [ this, index ]( int glyph ) {
+        return mesh( index, glyph );
+    };
+    fonts.push_back( std::move( entry ));
+    return index;
+}
+
+VectorFont &GlyphCache::font( int font )
+{
+    std::unique_lock< std::mutex > lock( mutex );
+    return *fonts[ font ]->font;
+}
+
+/* The mesh is extruded without the lock held. When two threads miss the same
+   glyph, the mesh stored first is used by both */
+
+VectorFont::GlyphMesh GlyphCache::mesh( int font, int glyph )
+{
+    Font *entry;
+    {
+        std::unique_lock< std::mutex > lock( mutex );
+        entry = fonts[ font ].get();
+        Slot &slot = entry->slots[ glyph ];
+        if( slot.mesh ) {
+            ++stats.hits;
+            recent.splice( recent.begin(), recent, slot.use );
+            return slot.mesh;
+        }
+        ++stats.misses;
+        VectorFont::GlyphMesh alive = slot.evicted.lock();
+        if( alive ) {
+            store( slot, font, glyph, alive );
+            return alive;
+        }
+    }
+    const VectorFont::Glyph &source = entry->font->readyGlyph( glyph );
+    VectorFont::GlyphMesh built = std::make_shared< const Triangles >( entry->font->extrudeGlyph( source.polys ));
+    std::unique_lock< std::mutex > lock( mutex );
+    Slot &slot = entry->slots[ glyph ];
+    if( slot.mesh )
+        return slot.mesh;
+    store( slot, font, glyph, built );
+    return built;
+}
+
+VectorFont::Text3D GlyphCache::placeChars( int font, const VectorFont::Layout &placements )
+{
+    VectorFont::Text3D chars3D;
+    chars3D.reserve( placements.size() );
+    for( const auto &placement : placements ) {
+        VectorFont::Char3D letter;
+        letter.geometry = mesh( font, placement.glyph );
+        letter.pos = Vector3D( placement.x, placement.y, 0 );
+        letter.charID = placement.charID;
+        letter.line = placement.line;
+        chars3D.push_back( letter );
+    }
+    return chars3D;
+}
+
+void GlyphCache::setBudget( size_t budget )
+{
+    std::unique_lock< std::mutex > lock( mutex );
+    this->budget = budget;
+    trim();
+}
+
+void GlyphCache::clear()
+{
+    std::unique_lock< std::mutex > lock( mutex );
+    for( auto &entry : fonts ) {
+        for( auto &slot : entry->slots ) {
+            slot.mesh.reset();
+            slot.evicted.reset();
+            slot.bytes = 0;
+        }
+    }
+    recent.clear();
+    stats.meshes = 0;
+    stats.bytes = 0;
+}
+
+GlyphCache::Counters GlyphCache::counters() const
+{
+    std::unique_lock< std::mutex > lock( mutex );
+    return stats;
+}
+
+void GlyphCache::report() const
+{
+    std::unique_lock< std::mutex > lock( mutex );
+    log_message( "Glyph cache: %zu hits, %zu misses, %zu evictions, %zu meshes in %zu of %zu bytes\n",
+                 stats.hits, stats.misses, stats.evictions, stats.meshes, stats.bytes, budget );
+}
+
+/* Called with the lock held, the mesh becomes the most recent one */
+
+void GlyphCache::store( Slot &slot, int font, int glyph, const VectorFont::GlyphMesh &mesh )
+{
+    slot.mesh = mesh;
+    slot.evicted.reset();
+    slot.bytes = meshBytes( *mesh );
+    Entry use = { font, glyph };
+    recent.push_front( use );
+    slot.use = recent.begin();
+    stats.bytes += slot.bytes;
+    ++stats.meshes;
+    trim();
+}
+
+/* Called with the lock held. The most recent mesh is kept even when it alone
+   exceeds the budget */
+
+void GlyphCache::trim()
+{
+    while( stats.bytes > budget && recent.size() > 1 ) {
+        const Entry oldest = recent.back();
+        Slot &slot = fonts[ oldest.font ]->slots[ oldest.glyph ];
+        stats.bytes -= slot.bytes;
+        slot.evicted = slot.mesh;
+        slot.mesh.reset();
+        slot.bytes = 0;
+        recent.pop_back();
+        --stats.meshes;
+        ++stats.evictions;
+    }
+}
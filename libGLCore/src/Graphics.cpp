@@ -6,6 +6,7 @@
 #include <iostream>
 #include <math.h>
 #include <map>
+#include <algorithm>
 
 using namespace std;
 
@@ -122,20 +123,20 @@ void Vector3D::operator *= ( float scale ) {
     z *= scale;
 }
 
-void Vector3D::operator *=( const Vector3D scale )
+void Vector3D::operator *=( const Vector3D &scale )
 {
     x *= scale.x;
     y *= scale.y;
     z *= scale.z;
 }
 
-void Vector3D::operator -= ( const Vector3D translate ) {
+void Vector3D::operator -= ( const Vector3D &translate ) {
     x -= translate.x;
     y -= translate.y;
     z -= translate.z;
 }
 
-void Vector3D::operator += ( const Vector3D translate ) {
+void Vector3D::operator += ( const Vector3D &translate ) {
     x += translate.x;
     y += translate.y;
     z += translate.z;
@@ -351,13 +352,50 @@ void Matrix::perspective( const float fov, const float aspect, const float nearp
     m[ 3 ][ 3 ] = 0;
 }
 
-Matrix operator * ( const Matrix mat1, const Matrix mat2 ) {
+Matrix Matrix::inverted() const {
+    const float *a = getFloatPtr();
+    Matrix result;
+    float *inv = result.getFloatPtr();
+    inv[0]  =  a[5] * a[10] * a[15] - a[5] * a[11] * a[14] - a[9] * a[6] * a[15] + a[9] * a[7] * a[14] + a[13] * a[6] * a[11] - a[13] * a[7] * a[10];
+    inv[4]  = -a[4] * a[10] * a[15] + a[4] * a[11] * a[14] + a[8] * a[6] * a[15] - a[8] * a[7] * a[14] - a[12] * a[6] * a[11] + a[12] * a[7] * a[10];
+    inv[8]  =  a[4] * a[9]  * a[15] - a[4] * a[11] * a[13] - a[8] * a[5] * a[15] + a[8] * a[7] * a[13] + a[12] * a[5] * a[11] - a[12] * a[7] * a[9];
+    inv[12] = -a[4] * a[9]  * a[14] + a[4] * a[10] * a[13] + a[8] * a[5] * a[14] - a[8] * a[6] * a[13] - a[12] * a[5] * a[10] + a[12] * a[6] * a[9];
+    inv[1]  = -a[1] * a[10] * a[15] + a[1] * a[11] * a[14] + a[9] * a[2] * a[15] - a[9] * a[3] * a[14] - a[13] * a[2] * a[11] + a[13] * a[3] * a[10];
+    inv[5]  =  a[0] * a[10] * a[15] - a[0] * a[11] * a[14] - a[8] * a[2] * a[15] + a[8] * a[3] * a[14] + a[12] * a[2] * a[11] - a[12] * a[3] * a[10];
+    inv[9]  = -a[0] * a[9]  * a[15] + a[0] * a[11] * a[13] + a[8] * a[1] * a[15] - a[8] * a[3] * a[13] - a[12] * a[1] * a[11] + a[12] * a[3] * a[9];
+    inv[13] =  a[0] * a[9]  * a[14] - a[0] * a[10] * a[13] - a[8] * a[1] * a[14] + a[8] * a[2] * a[13] + a[12] * a[1] * a[10] - a[12] * a[2] * a[9];
+    inv[2]  =  a[1] * a[6]  * a[15] - a[1] * a[7]  * a[14] - a[5] * a[2] * a[15] + a[5] * a[3] * a[14] + a[13] * a[2] * a[7]  - a[13] * a[3] * a[6];
+    inv[6]  = -a[0] * a[6]  * a[15] + a[0] * a[7]  * a[14] + a[4] * a[2] * a[15] - a[4] * a[3] * a[14] - a[12] * a[2] * a[7]  + a[12] * a[3] * a[6];
+    inv[10] =  a[0] * a[5]  * a[15] - a[0] * a[7]  * a[13] - a[4] * a[1] * a[15] + a[4] * a[3] * a[13] + a[12] * a[1] * a[7]  - a[12] * a[3] * a[5];
+    inv[14] = -a[0] * a[5]  * a[14] + a[0] * a[6]  * a[13] + a[4] * a[1] * a[14] - a[4] * a[2] * a[13] - a[12] * a[1] * a[6]  + a[12] * a[2] * a[5];
+    inv[3]  = -a[1] * a[6]  * a[11] + a[1] * a[7]  * a[10] + a[5] * a[2] * a[11] - a[5] * a[3] * a[10] - a[9]  * a[2] * a[7]  + a[9]  * a[3] * a[6];
+    inv[7]  =  a[0] * a[6]  * a[11] - a[0] * a[7]  * a[10] - a[4] * a[2] * a[11] + a[4] * a[3] * a[10] + a[8]  * a[2] * a[7]  - a[8]  * a[3] * a[6];
+    inv[11] = -a[0] * a[5]  * a[11] + a[0] * a[7]  * a[9]  + a[4] * a[1] * a[11] - a[4] * a[3] * a[9]  - a[8]  * a[1] * a[7]  + a[8]  * a[3] * a[5];
+    inv[15] =  a[0] * a[5]  * a[10] - a[0] * a[6]  * a[9]  - a[4] * a[1] * a[10] + a[4] * a[2] * a[9]  + a[8]  * a[1] * a[6]  - a[8]  * a[2] * a[5];
+    float det = a[0] * inv[0] + a[1] * inv[4] + a[2] * inv[8] + a[3] * inv[12];
+    if( !det )
+        return Matrix();
+    det = 1.f / det;
+    for( int i = 0; i < 16; ++i )
+        inv[i] *= det;
+    return result;
+}
+
+Vector3D Matrix::project( const Vector3D &point ) const {
+    Vector3D result = *this * point;
+    float w = m[0][3] * point.x + m[1][3] * point.y + m[2][3] * point.z + m[3][3];
+    if( w && w != 1.f )
+        result *= 1.f / w;
+    return result;
+}
+
+Matrix operator * ( const Matrix &mat1, const Matrix &mat2 ) {
     Matrix result = mat1;
     result *= mat2;
     return result;
 }
 
-Vector3D operator * ( const Matrix matrix, const Vector3D point ) {
+Vector3D operator * ( const Matrix &matrix, const Vector3D &point ) {
     Vector3D result;
     result.x = matrix.m[0][0] * point.x + matrix.m[1][0] * point.y + matrix.m[2][0] * point.z + matrix.m[3][0];
     result.y = matrix.m[0][1] * point.x + matrix.m[1][1] * point.y + matrix.m[2][1] * point.z + matrix.m[3][1];
@@ -367,23 +405,27 @@ Vector3D operator * ( const Matrix matrix, const Vector3D point ) {
 
 Plane::Plane() { }
 
-Plane::Plane(vector<Vector2D> &points) : vector<Vector2D>( points ) {}
+Plane::Plane( const vector<Vector2D> &points ) : vector<Vector2D>( points ) {}
+
+Plane::Plane( vector<Vector2D> &&points ) : vector<Vector2D>( std::move( points )) {}
 
 const Plane Plane::reversed() const {
     Plane back;
-    for( auto &point : *this ) {
-        back.insert( back.begin(), point );
-    }
+    back.assign( rbegin(), rend() );
     return back;
 }
 
-void Plane::shift( Vector2D shift ) {
+void Plane::reverse() {
+    std::reverse( begin(), end() );
+}
+
+void Plane::shift( const Vector2D &shift ) {
     for( auto &point : *this ) {
         point += shift;
     }
 }
 
-int Mesh::addVertex( const Vector3D pos, const Vector3D norm )
+int Mesh::addVertex( const Vector3D &pos, const Vector3D &norm )
 {
     size_t vSize = mVertices.size();
     if( mVertices.size() != mNormals.size() )
@@ -405,23 +447,20 @@ int Mesh::addVertex( const Vector3D pos, const Vector3D norm )
 }
 
 Mesh *Mesh::flip() {
-    vector<uint> indices = mIndices;
-    mIndices.clear();
-    for( auto &index : indices )
-        mIndices.insert( mIndices.begin(), index );
+    std::reverse( mIndices.begin(), mIndices.end() );
     for( auto &normal : mNormals )
         normal *= -1;
     return this;
 }
 
-Mesh *Mesh::shift( const Vector3D shift ) {
+Mesh *Mesh::shift( const Vector3D &shift ) {
     for( auto &point : mVertices ) {
         point += shift;
     }
     return this;
 }
 
-Mesh *Mesh::rotate( const float angle, const Vector3D axis ) {
+Mesh *Mesh::rotate( const float angle, const Vector3D &axis ) {
     Matrix matrix;
     matrix.rotate( angle, axis );
     transform( matrix );
@@ -436,7 +475,7 @@ Mesh *Mesh::scale(float scale)
     return this;
 }
 
-Mesh *Mesh::transform( const Matrix matrix ) {
+Mesh *Mesh::transform( const Matrix &matrix ) {
     for( auto &point : mVertices ) {
         point = matrix * point;
     }
@@ -450,11 +489,22 @@ void Mesh::operator += ( const Mesh &other ) {
     int startIDX = mVertices.size();
     mVertices.insert( mVertices.end(), other.mVertices.begin(), other.mVertices.end()) ;
     mNormals.insert( mNormals.end(), other.mNormals.begin(), other.mNormals.end()) ;
+    mIndices.reserve( mIndices.size() + other.mIndices.size() );
     for( auto index : other.mIndices ) {
         mIndices.push_back( startIDX + index );
     }
 }
 
+void Mesh::operator += ( Mesh &&other ) {
+    if( !mVertices.empty() || !mIndices.empty() ) {
+        operator += ( static_cast< const Mesh& >( other ));
+        return;
+    }
+    mVertices = std::move( other.mVertices );
+    mNormals = std::move( other.mNormals );
+    mIndices = std::move( other.mIndices );
+}
+
 Mesh Mesh::optimized()
 {
     std::multimap<float, uint>  distmap;
@@ -517,3 +567,9 @@ void Mesh::clear() {
     mNormals.clear();
     mIndices.clear();
 }
+
+void TexturedMesh::clear() {
+    mVertices.clear();
+    mTexCoords.clear();
+    mIndices.clear();
+}
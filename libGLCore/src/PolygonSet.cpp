@@ -0,0 +1,206 @@
+#include "PolygonSet.h"
+#include <algorithm>
+#if defined( __SSE__ )
+#include <xmmintrin.h>
+#endif
+
+namespace {
+
+static_assert( sizeof( Vector2D ) == 2 * sizeof( float ), "points are read as packed floats" );
+
+/* Bounding box of a contour, two points per SSE register where available */
+
+PolygonSet::Box contourBox( const Vector2D *points, size_t count )
+{
+    PolygonSet::Box box = { 0, 0, 0, 0 };
+    if( !count )
+        return box;
+    box.minx = box.maxx = points[ 0 ].x;
+    box.miny = box.maxy = points[ 0 ].y;
+    size_t i = 1;
+#if defined( __SSE__ )
+    if( count >= 2 ) {
+        const float *coords = reinterpret_cast< const float* >( points );
+        __m128 low = _mm_loadu_ps( coords );
+        __m128 high = low;
+        for( i = 2; i + 2 <= count; i += 2 ) {
+            const __m128 pair = _mm_loadu_ps( coords + 2 * i );
+            low = _mm_min_ps( low, pair );
+            high = _mm_max_ps( high, pair );
+        }
+        low = _mm_min_ps( low, _mm_movehl_ps( low, low ));
+        high = _mm_max_ps( high, _mm_movehl_ps( high, high ));
+        float lows[ 4 ];
+        float highs[ 4 ];
+        _mm_storeu_ps( lows, low );
+        _mm_storeu_ps( highs, high );
+        box.minx = lows[ 0 ];
+        box.miny = lows[ 1 ];
+        box.maxx = highs[ 0 ];
+        box.maxy = highs[ 1 ];
+    }
+#endif
+    for( ; i < count; ++i ) {
+        box.minx = std::min( box.minx, points[ i ].x );
+        box.miny = std::min( box.miny, points[ i ].y );
+        box.maxx = std::max( box.maxx, points[ i ].x );
+        box.maxy = std::max( box.maxy, points[ i ].y );
+    }
+    return box;
+}
+
+} // namespace
+
+PolygonSet::PolygonSet() : offsets( 1, 0 )
+{
+}
+
+void PolygonSet::clear()
+{
+    points.clear();
+    offsets.assign( 1, 0 );
+    parents.clear();
+    boxes.clear();
+}
+
+bool PolygonSet::isEmpty() const
+{
+    return parents.empty();
+}
+
+size_t PolygonSet::contourCount() const
+{
+    return parents.size();
+}
+
+size_t PolygonSet::contourSize( size_t contour ) const
+{
+    return offsets[ contour + 1 ] - offsets[ contour ];
+}
+
+const Vector2D *PolygonSet::contour( size_t contour ) const
+{
+    return points.data() + offsets[ contour ];
+}
+
+int PolygonSet::addContour( const Vector2D *begin, size_t count, int parent )
+{
+    points.insert( points.end(), begin, begin + count );
+    offsets.push_back( points.size() );
+    parents.push_back( parent );
+    boxes.push_back( contourBox( begin, count ));
+    return parents.size() - 1;
+}
+
+int PolygonSet::addContour( const Face &face, int parent )
+{
+    return addContour( face.data(), face.size(), parent );
+}
+
+void PolygonSet::append( const PolygonSet &other )
+{
+    const int firstContour = contourCount();
+    const uint firstPoint = points.size();
+    points.insert( points.end(), other.points.begin(), other.points.end() );
+    for( size_t i = 1; i < other.offsets.size(); ++i )
+        offsets.push_back( firstPoint + other.offsets[ i ] );
+    for( int parent : other.parents )
+        parents.push_back( parent < 0 ? parent : firstContour + parent );
+    boxes.insert( boxes.end(), other.boxes.begin(), other.boxes.end() );
+}
+
+void PolygonSet::reverse( size_t contour )
+{
+    std::reverse( points.begin() + offsets[ contour ], points.begin() + offsets[ contour + 1 ] );
+}
+
+void PolygonSet::reverse()
+{
+    for( size_t i = 0; i < contourCount(); ++i )
+        reverse( i );
+}
+
+void PolygonSet::computeBoxes()
+{
+    boxes.resize( contourCount() );
+    for( size_t i = 0; i < contourCount(); ++i )
+        boxes[ i ] = contourBox( contour( i ), contourSize( i ));
+}
+
+void PolygonSet::shrinkToFit()
+{
+    points.shrink_to_fit();
+    offsets.shrink_to_fit();
+    parents.shrink_to_fit();
+    boxes.shrink_to_fit();
+}
+
+PolygonSet::Box PolygonSet::bounds() const
+{
+    if( boxes.empty() ) {
+        Box empty = { 0, 0, 0, 0 };
+        return empty;
+    }
+    Box box = boxes.front();
+    for( const auto &other : boxes ) {
+        box.minx = std::min( box.minx, other.minx );
+        box.miny = std::min( box.miny, other.miny );
+        box.maxx = std::max( box.maxx, other.maxx );
+        box.maxy = std::max( box.maxy, other.maxy );
+    }
+    return box;
+}
+
+Face PolygonSet::face( size_t contour ) const
+{
+    return Face( vector< Vector2D >( this->contour( contour ), this->contour( contour ) + contourSize( contour )));
+}
+
+Faces PolygonSet::holes( size_t contour ) const
+{
+    Faces faces;
+    for( size_t i = 0; i < contourCount(); ++i ) {
+        if( parents[ i ] == int( contour ))
+            faces.push_back( face( i ));
+    }
+    return faces;
+}
+
+BBoxFace PolygonSet::boxFace( size_t contour ) const
+{
+    BBoxFace face;
+    face.assign( this->contour( contour ), this->contour( contour ) + contourSize( contour ));
+    face.minx = boxes[ contour ].minx;
+    face.miny = boxes[ contour ].miny;
+    face.maxx = boxes[ contour ].maxx;
+    face.maxy = boxes[ contour ].maxy;
+    return face;
+}
+
+std::vector< std::pair< Face, std::vector< Face >>> PolygonSet::grouped() const
+{
+    std::vector< std::pair< Face, std::vector< Face >>> polys;
+    std::vector< int > slots( contourCount(), -1 );
+    for( size_t i = 0; i < contourCount(); ++i ) {
+        if( parents[ i ] < 0 ) {
+            slots[ i ] = polys.size();
+            polys.push_back( std::pair< Face, std::vector< Face >>( face( i ), std::vector< Face >() ));
+        }
+    }
+    for( size_t i = 0; i < contourCount(); ++i ) {
+        if( parents[ i ] >= 0 && slots[ parents[ i ]] >= 0 )
+            polys[ slots[ parents[ i ]]].second.push_back( face( i ));
+    }
+    return polys;
+}
+
+PolygonSet PolygonSet::fromGrouped( const std::vector< std::pair< Face, std::vector< Face >>> &polys )
+{
+    PolygonSet set;
+    for( const auto &poly : polys ) {
+        const int outer = set.addContour( poly.first );
+        for( const auto &hole : poly.second )
+            set.addContour( hole, outer );
+    }
+    return set;
+}
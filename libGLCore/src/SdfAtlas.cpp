@@ -0,0 +1,154 @@
+#include "SdfAtlas.h"
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace {
+
+const int cellGap = 1;
+
+/* Outline edges as plain floats, every sample is tested against all of them */
+
+void addEdges( std::vector< float > &edges, const Vector2D *contour, size_t count )
+{
+    for( size_t i = 0; i < count; ++i ) {
+        const Vector2D &from = contour[ i ];
+        const Vector2D &to = contour[( i + 1 ) % count ];
+        edges.push_back( from.x );
+        edges.push_back( from.y );
+        edges.push_back( to.x );
+        edges.push_back( to.y );
+    }
+}
+
+/* Distance to the nearest edge, positive inside by the even-odd rule */
+
+float signedDistance( const std::vector< float > &edges, float x, float y )
+{
+    float nearest = std::numeric_limits< float >::max();
+    bool inside = false;
+    for( size_t i = 0; i < edges.size(); i += 4 ) {
+        const float ax = edges[ i ];
+        const float ay = edges[ i + 1 ];
+        const float ex = edges[ i + 2 ] - ax;
+        const float ey = edges[ i + 3 ] - ay;
+        const float px = x - ax;
+        const float py = y - ay;
+        const float length = ex * ex + ey * ey;
+        const float t = length > 0 ? std::min( std::max(( px * ex + py * ey ) / length, 0.f ), 1.f ) : 0;
+        const float dx = px - ex * t;
+        const float dy = py - ey * t;
+        nearest = std::min( nearest, dx * dx + dy * dy );
+        if(( ay > y ) != ( ay + ey > y ) && x < ax + ( y - ay ) * ex / ey )
+            inside = !inside;
+    }
+    return inside ? sqrtf( nearest ) : -sqrtf( nearest );
+}
+
+} // namespace
+
+SdfAtlas::SdfAtlas() : pixelsPerUnit( 16 ), spread( 0.25f ), width( 0 ), height( 0 )
+{
+}
+
+void SdfAtlas::build( VectorFont &font, ThreadPool *pool )
+{
+    const size_t count = font.glyphs.size();
+    cells.assign( count, Cell() );
+    size_t area = 0;
+    int widest = 0;
+    for( size_t i = 0; i < count; ++i ) {
+        const BBoxFace &box = font.glyphs[ i ].box;
+        Cell &cell = cells[ i ];
+        cell.width = ceilf(( box.maxx - box.minx + 2 * spread ) * pixelsPerUnit );
+        cell.height = ceilf(( box.maxy - box.miny + 2 * spread ) * pixelsPerUnit );
+        cell.minx = box.minx - spread;
+        cell.miny = box.miny - spread;
+        cell.maxx = cell.minx + cell.width / pixelsPerUnit;
+        cell.maxy = cell.miny + cell.height / pixelsPerUnit;
+        area += ( cell.width + cellGap ) * ( cell.height + cellGap );
+        widest = std::max( widest, cell.width );
+    }
+
+    /* Shelf packing, tallest cells first */
+
+    std::vector< size_t > order( count );
+    for( size_t i = 0; i < count; ++i )
+        order[ i ] = i;
+    std::stable_sort( order.begin(), order.end(), [ this ]( size_t a, size_t b ) {
+        return cells[ a ].height > cells[ b ].height;
+    } );
+    width = 64;
+    while( size_t( width ) * width < area || width < widest )
+        width *= 2;
+    int x = 0;
+    int y = 0;
+    int shelf = 0;
+    for( size_t i : order ) {
+        Cell &cell = cells[ i ];
+        if( x + cell.width > width ) {
+            x = 0;
+            y += shelf + cellGap;
+            shelf = 0;
+        }
+        cell.x = x;
+        cell.y = y;
+        x += cell.width + cellGap;
+        shelf = std::max( shelf, cell.height );
+    }
+    height = y + shelf;
+    pixels.assign( size_t( width ) * height, 0 );
+
+    /* Every glyph writes its own cell only. Deferred glyphs may be built
+       meanwhile, so their contours are grouped again from the outlines */
+
+    ThreadPool &workers = pool ? *pool : ThreadPool::global();
+    workers.parallelFor( count, [ this, &font ]( size_t i ) {
+        const VectorFont::Glyph &glyph = font.glyphs[ i ];
+        const Cell &cell = cells[ i ];
+        std::vector< float > edges;
+        const bool built = !glyph.deferred && !glyph.polys.isEmpty();
+        const PolygonSet contours = built ? glyph.polys : font.groupContours( glyph.outlines );
+        for( size_t contour = 0; contour < contours.contourCount(); ++contour )
+            addEdges( edges, contours.contour( contour ), contours.contourSize( contour ));
+        const float scale = 127 / spread;
+        for( int row = 0; row < cell.height; ++row ) {
+            const float sy = cell.miny + ( row + 0.5f ) / pixelsPerUnit;
+            unsigned char *out = pixels.data() + size_t( cell.y + row ) * width + cell.x;
+            for( int column = 0; column < cell.width; ++column ) {
+                const float sx = cell.minx + ( column + 0.5f ) / pixelsPerUnit;
+                const float value = 128 + signedDistance( edges, sx, sy ) * scale;
+                out[ column ] = std::min( std::max( value + 0.5f, 0.f ), 255.f );
+            }
+        }
+    } );
+}
+
+/* Clockwise quads, the same front face as the glyph meshes */
+
+TexturedMesh SdfAtlas::genText( const VectorFont::Layout &placements ) const
+{
+    TexturedMesh mesh;
+    mesh.mVertices.reserve( placements.size() * 4 );
+    mesh.mTexCoords.reserve( placements.size() * 4 );
+    mesh.mIndices.reserve( placements.size() * 6 );
+    for( const auto &placement : placements ) {
+        const Cell &cell = cells[ placement.glyph ];
+        const uint base = mesh.mVertices.size();
+        const float u0 = float( cell.x ) / width;
+        const float u1 = float( cell.x + cell.width ) / width;
+        const float v0 = float( cell.y ) / height;
+        const float v1 = float( cell.y + cell.height ) / height;
+        mesh.mVertices.push_back( Vector3D( placement.x + cell.minx, placement.y + cell.miny, 0 ));
+        mesh.mVertices.push_back( Vector3D( placement.x + cell.minx, placement.y + cell.maxy, 0 ));
+        mesh.mVertices.push_back( Vector3D( placement.x + cell.maxx, placement.y + cell.maxy, 0 ));
+        mesh.mVertices.push_back( Vector3D( placement.x + cell.maxx, placement.y + cell.miny, 0 ));
+        mesh.mTexCoords.push_back( Vector2D( u0, v0 ));
+        mesh.mTexCoords.push_back( Vector2D( u0, v1 ));
+        mesh.mTexCoords.push_back( Vector2D( u1, v1 ));
+        mesh.mTexCoords.push_back( Vector2D( u1, v0 ));
+        const uint quad[ 6 ] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+        mesh.mIndices.insert( mesh.mIndices.end(), quad, quad + 6 );
+    }
+    return mesh;
+}
@@ -2,7 +2,53 @@
 
 float TriangleGeneators::auto_smooth_angle = 0.35;
 
-Triangles TriangleGeneators::bevelEdge( Face polygon, float height, float depth, float radius, int slices, bool smooth )
+BuildProfile::BuildProfile()
+{
+    for( auto &stage : micros )
+        stage = 0;
+}
+
+float BuildProfile::total() const
+{
+    float sum = 0;
+    for( auto stage : micros )
+        sum += stage;
+    return sum;
+}
+
+BuildProfile *&BuildProfile::current()
+{
+    static thread_local BuildProfile *profile = nullptr;
+    return profile;
+}
+
+const char *BuildProfile::stageName( int stage )
+{
+    static const char *names[ StageCount ] = { "drill", "fillFace", "bevel", "cylinder", "optimized" };
+    return stage >= 0 && stage < StageCount ? names[ stage ] : "";
+}
+
+BuildProfile::Scope::Scope( BuildProfile *profile ) : previous( current() )
+{
+    current() = profile;
+}
+
+BuildProfile::Scope::~Scope()
+{
+    current() = previous;
+}
+
+BuildProfile::Timing::Timing( Stage stage ) : profile( current() ), stage( stage )
+{
+}
+
+BuildProfile::Timing::~Timing()
+{
+    if( profile )
+        profile->micros[ stage ] += timer.duration();
+}
+
+Triangles TriangleGeneators::bevelEdge( const Face &polygon, float height, float depth, float radius, int slices, bool smooth )
 {
     Triangles triangles;
     Face outside = FaceGeneators::grow( polygon, depth );
@@ -17,7 +63,7 @@ Triangles TriangleGeneators::bevelEdge( Face polygon, float height, float depth,
     return triangles;
 }
 
-Triangles TriangleGeneators::bevelExtrude( const Face polygon, float height, float radius, int slices, bool smooth, bool cap )
+Triangles TriangleGeneators::bevelExtrude( const Face &polygon, float height, float radius, int slices, bool smooth, bool cap )
 {
     Triangles triangles;
     if( cap ) {
@@ -30,9 +76,13 @@ Triangles TriangleGeneators::bevelExtrude( const Face polygon, float height, flo
     return triangles;
 }
 
-Triangles TriangleGeneators::bevelExtrude( const Face polygon, const Faces holes, float height, float radius, int slices, bool smooth, bool cap )
+Triangles TriangleGeneators::bevelExtrude( const Face &polygon, const Faces &holes, float height, float radius, int slices, bool smooth, bool cap )
 {
-    const Face face = FaceGeneators::drill( polygon, holes );
+    Face face;
+    {
+        BuildProfile::Timing timing( BuildProfile::Drill );
+        face = FaceGeneators::drill( polygon, holes );
+    }
     Triangles triangles = bevelExtrude( polygon, height, radius, slices, smooth, false );
     if( cap ) {
         fillFace( triangles, face, height * 0.5, false );
@@ -46,10 +96,10 @@ Triangles TriangleGeneators::bevelExtrude( const Face polygon, const Faces holes
     return triangles;
 }
 
-Triangles TriangleGeneators::revolution( const Faces polygons, float radius, float angleStep, bool smooth, bool close )
+Triangles TriangleGeneators::revolution( const Faces &polygons, float radius, float angleStep, bool smooth, bool close )
 {
     Triangles triangles;
-    for( auto polygon : polygons ) {
+    for( const auto &polygon : polygons ) {
         bool flip = FaceGeneators::checkOrientation( polygon );
         if( polygon.size() < 3 )
             continue;
@@ -58,7 +108,7 @@ Triangles TriangleGeneators::revolution( const Faces polygons, float radius, flo
             Vector2D v1( *polygon.begin() - *polygon.rbegin() );
             auto p2 = polygon.begin() + 1;
             float prevangle = atan2( -v1.y, v1.x );
-            for( auto p1 : polygon ) {
+            for( const auto &p1 : polygon ) {
                 Vector2D v1( *p2 - p1 );
                 ++p2;
                 if( p2 == polygon.end() )
@@ -76,11 +126,11 @@ Triangles TriangleGeneators::revolution( const Faces polygons, float radius, flo
             for( int i = 0; i <= fullangle; ++i ) {
                 int startIDX = triangles.mVertices.size();
                 float angleRad = i * angleStep * degToRad;
-                for( auto point : polygon ) {
+                for( const auto &point : polygon ) {
                     float dist = radius + point.x;
                     triangles.mVertices.push_back( Vector3D( dist * sin( angleRad ), dist * cos( angleRad ), point.y ));
                 }
-                for( auto normalVector : normals ) {
+                for( const auto &normalVector : normals ) {
                     float dist = normalVector.x;
                     triangles.mNormals.push_back( Vector3D( dist * sin( angleRad ), dist * cos( angleRad ), normalVector.y));
                 }
@@ -108,7 +158,7 @@ Triangles TriangleGeneators::revolution( const Faces polygons, float radius, flo
             }
         } else {
             auto p2 = polygon.begin() + 1;
-            for( auto p1 : polygon ) {
+            for( const auto &p1 : polygon ) {
                 Vector2D v1( *p2 - p1 );
                 ++p2;
                 if( p2 == polygon.end() )
@@ -120,14 +170,14 @@ Triangles TriangleGeneators::revolution( const Faces polygons, float radius, flo
             for( int i = 0; i <= fullangle; ++i ) {
                 int startIDX = triangles.mVertices.size();
                 float angleRad = i * angleStep * degToRad;
-                for( auto point : polygon ) {
+                for( const auto &point : polygon ) {
                     float dist = radius + point.x;
                     triangles.mVertices.push_back( Vector3D( dist * sin( angleRad ), dist * cos( angleRad ), point.y ));
                     triangles.mVertices.push_back( *triangles.mVertices.rbegin() );
                 }
                 triangles.mVertices.push_back( triangles.mVertices.at( startIDX ));
                 triangles.mVertices.erase( triangles.mVertices.begin() + startIDX );
-                for( auto normalVector : normals ) {
+                for( const auto &normalVector : normals ) {
                     float dist = normalVector.x;
                     triangles.mNormals.push_back( Vector3D( dist * sin( angleRad ), dist * cos( angleRad ), normalVector.y ));
                     triangles.mNormals.push_back( *triangles.mNormals.rbegin() );
@@ -161,8 +211,9 @@ Triangles TriangleGeneators::revolution( const Faces polygons, float radius, flo
     return triangles;
 }
 
-void TriangleGeneators::bevel( Triangles &triangles, Face polygon, float depth, float radius, float slices, bool flip, bool in )
+void TriangleGeneators::bevel( Triangles &triangles, const Face &polygon, float depth, float radius, float slices, bool flip, bool in )
 {
+    BuildProfile::Timing timing( BuildProfile::Bevel );
     Tangents tangents = FaceGeneators::generateTangents( polygon );
 
     const int pointCount = polygon.size();
@@ -231,13 +282,14 @@ void TriangleGeneators::bevel( Triangles &triangles, Face polygon, float depth,
                 triangles.mIndices.push_back( id2 );
             }
         }
-        polygon1 = polygon2;
+        polygon1 = std::move( polygon2 );
         up1 = up2;
     }
 }
 
-void TriangleGeneators::cylinder( Triangles &triangles, Face polygon, float depth, bool smooth, bool cw )
+void TriangleGeneators::cylinder( Triangles &triangles, const Face &polygon, float depth, bool smooth, bool cw )
 {
+    BuildProfile::Timing timing( BuildProfile::Cylinder );
     (void) smooth;
     Tangents tangents = FaceGeneators::generateTangents( polygon );
     const int pointCount = polygon.size();
@@ -280,7 +332,7 @@ void TriangleGeneators::cylinder( Triangles &triangles, Face polygon, float dept
     }
 }
 
-void TriangleGeneators::fillEdge( Triangles &triangles, Face polygon, float width, float depth, bool cw )
+void TriangleGeneators::fillEdge( Triangles &triangles, const Face &polygon, float width, float depth, bool cw )
 {
     const int pointCount = polygon.size();
     Face big = FaceGeneators::grow( polygon, width );
@@ -312,8 +364,9 @@ void TriangleGeneators::fillEdge( Triangles &triangles, Face polygon, float widt
 
 }
 
-void TriangleGeneators::fillFace( Triangles &triangles, const Face polygon, float depth, bool bottom )
+void TriangleGeneators::fillFace( Triangles &triangles, const Face &polygon, float depth, bool bottom )
 {
+    BuildProfile::Timing timing( BuildProfile::FillFace );
     Face points = polygon;
     const int pointCount = points.size();
 
@@ -0,0 +1,185 @@
+#include "TrueTypeFont.h"
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "stb_truetype.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double emUnits = 2.048;
+
+/* Without a tolerance curves are split into steps segments of equal
+   parameter length, the same way fontParser splits them. With one the count
+   comes from the largest second difference of the control points (Wang's
+   formula), so no segment strays further than the tolerance from the curve */
+
+struct ContourBuilder
+{
+    TrueTypeFont::Outlines                  &outlines;
+    std::vector< std::pair< double, double >> contour;
+    double                                  scale;
+    int                                     steps;
+    double                                  tolerance;
+    double                                  x;
+    double                                  y;
+
+    void addPoint( double px, double py ) {
+        contour.push_back( std::make_pair( px * scale, py * scale ));
+        x = px;
+        y = py;
+    }
+    void moveTo( double px, double py ) {
+        finish();
+        addPoint( px, py );
+    }
+    int segments( double bend, double degreeFactor ) const {
+        if( tolerance <= 0 )
+            return steps;
+        const double count = std::ceil( std::sqrt( degreeFactor * bend * scale / tolerance ));
+        return std::max( 1, std::min( TrueTypeFont::maxSegments, int( count )));
+    }
+    void conicTo( double cx, double cy, double px, double py ) {
+        const double sx = x;
+        const double sy = y;
+        const int count = segments( std::hypot( sx - 2 * cx + px, sy - 2 * cy + py ), 0.25 );
+        for( int i = 1; i <= count; ++i ) {
+            const double u = double( i ) / count;
+            const double nu = 1 - u;
+            addPoint( sx * nu * nu + cx * 2 * nu * u + px * u * u, sy * nu * nu + cy * 2 * nu * u + py * u * u );
+        }
+    }
+    void cubicTo( double c1x, double c1y, double c2x, double c2y, double px, double py ) {
+        const double sx = x;
+        const double sy = y;
+        const double bend = std::max( std::hypot( sx - 2 * c1x + c2x, sy - 2 * c1y + c2y ),
+                                      std::hypot( c1x - 2 * c2x + px, c1y - 2 * c2y + py ));
+        const int count = segments( bend, 0.75 );
+        for( int i = 1; i <= count; ++i ) {
+            const double u = double( i ) / count;
+            const double nu = 1 - u;
+            addPoint( sx * nu * nu * nu + c1x * 3 * nu * nu * u + c2x * 3 * nu * u * u + px * u * u * u,
+                      sy * nu * nu * nu + c1y * 3 * nu * nu * u + c2y * 3 * nu * u * u + py * u * u * u );
+        }
+    }
+
+    /* The closing point repeats the first one. Every contour is made
+       counter-clockwise, holes included, as fontParser does */
+
+    void finish() {
+        if( contour.size() > 1 && contour.back() == contour.front() )
+            contour.pop_back();
+        if( contour.empty() )
+            return;
+        double area = 0;
+        for( size_t i = 0; i < contour.size(); ++i ) {
+            const auto &from = contour[ i ];
+            const auto &to = contour[( i + 1 ) % contour.size() ];
+            area += from.first * to.second - to.first * from.second;
+        }
+        if( area < 0 )
+            std::reverse( contour.begin(), contour.end() );
+        outlines.push_back( std::move( contour ));
+        contour.clear();
+    }
+};
+
+} // namespace
+
+const int TrueTypeFont::maxSegments;
+
+TrueTypeFont::TrueTypeFont( const char *filename ) : steps( 4 ), tolerance( 0 ), scale( 0 )
+{
+    if( filename )
+        open( filename );
+}
+
+TrueTypeFont::~TrueTypeFont()
+{
+}
+
+bool TrueTypeFont::open( const char *filename )
+{
+    close();
+    if( !file.open( filename ))
+        return false;
+    const int offset = stbtt_GetFontOffsetForIndex( file.data, 0 );
+    info.reset( new stbtt_fontinfo );
+    if( offset < 0 || !stbtt_InitFont( info.get(), file.data, offset )) {
+        close();
+        return false;
+    }
+    scale = emUnits * stbtt_ScaleForMappingEmToPixels( info.get(), 1 );
+    return true;
+}
+
+void TrueTypeFont::close()
+{
+    info.reset();
+    file.close();
+}
+
+bool TrueTypeFont::isOpen() const
+{
+    return info.get() != nullptr;
+}
+
+bool TrueTypeFont::hasGlyph( long charID ) const
+{
+    return info && stbtt_FindGlyphIndex( info.get(), charID ) != 0;
+}
+
+TrueTypeFont::Outlines TrueTypeFont::outlines( long charID ) const
+{
+    Outlines outlines;
+    if( !hasGlyph( charID ))
+        return outlines;
+    stbtt_vertex *vertices = nullptr;
+    const int count = stbtt_GetCodepointShape( info.get(), charID, &vertices );
+    ContourBuilder builder = { outlines, std::vector< std::pair< double, double >>(), scale, steps, tolerance, 0, 0 };
+    for( int i = 0; i < count; ++i ) {
+        const stbtt_vertex &vertex = vertices[ i ];
+        switch( vertex.type ) {
+        case STBTT_vmove:
+            builder.moveTo( vertex.x, vertex.y );
+            break;
+        case STBTT_vline:
+            builder.addPoint( vertex.x, vertex.y );
+            break;
+        case STBTT_vcurve:
+            builder.conicTo( vertex.cx, vertex.cy, vertex.x, vertex.y );
+            break;
+        case STBTT_vcubic:
+            builder.cubicTo( vertex.cx, vertex.cy, vertex.cx1, vertex.cy1, vertex.x, vertex.y );
+            break;
+        default:
+            break;
+        }
+    }
+    builder.finish();
+    stbtt_FreeShape( info.get(), vertices );
+    return outlines;
+}
+
+/* An em is emUnits wide in the outlines, a pixel of it is emUnits / pixelsPerEm */
+
+float TrueTypeFont::toleranceFor( float pixelsPerEm, float pixelError )
+{
+    return pixelsPerEm > 0 ? float( emUnits * pixelError / pixelsPerEm ) : 0;
+}
+
+/* Characters missing from the font or without contours, like the space,
+   are left out, the layout skips them */
+
+TrueTypeFont::Source TrueTypeFont::source( const std::vector< char32_t > &charIDs ) const
+{
+    Source source;
+    for( char32_t charID : charIDs ) {
+        if( source.count( charID ))
+            continue;
+        Outlines glyph = outlines( charID );
+        if( !glyph.empty() )
+            source.insert( std::make_pair( long( charID ), std::move( glyph )));
+    }
+    return source;
+}
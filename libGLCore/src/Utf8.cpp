@@ -0,0 +1,213 @@
+#include "Utf8.h"
+#include <cstring>
+#include <algorithm>
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+enum STEP {
+    ST_DONE,
+    ST_INCOMPLETE,
+    ST_INVALID
+};
+
+/* Decodes one sequence. On an invalid sequence pos skips the maximal valid
+   prefix, on an incomplete one pos is left untouched */
+
+STEP step( const unsigned char *&pos, const unsigned char *end, char32_t &codepoint )
+{
+    unsigned char lead = *pos;
+    if( lead < 0x80 ) {
+        codepoint = lead;
+        ++pos;
+        return ST_DONE;
+    }
+    int need;
+    unsigned char low = 0x80;
+    unsigned char high = 0xbf;
+    if( lead >= 0xc2 && lead <= 0xdf ) {
+        need = 1;
+        codepoint = lead & 0x1f;
+    } else if( lead >= 0xe0 && lead <= 0xef ) {
+        need = 2;
+        codepoint = lead & 0x0f;
+        if( lead == 0xe0 )
+            low = 0xa0;
+        if( lead == 0xed )
+            high = 0x9f;
+    } else if( lead >= 0xf0 && lead <= 0xf4 ) {
+        need = 3;
+        codepoint = lead & 0x07;
+        if( lead == 0xf0 )
+            low = 0x90;
+        if( lead == 0xf4 )
+            high = 0x8f;
+    } else {
+        codepoint = Utf8Decoder::replacement;
+        ++pos;
+        return ST_INVALID;
+    }
+    const unsigned char *actual = pos + 1;
+    for( int i = 0; i < need; ++i, ++actual ) {
+        if( actual == end )
+            return ST_INCOMPLETE;
+        if( *actual < low || *actual > high ) {
+            codepoint = Utf8Decoder::replacement;
+            pos = actual;
+            return ST_INVALID;
+        }
+        codepoint = codepoint << 6 | ( *actual & 0x3f );
+        low = 0x80;
+        high = 0xbf;
+    }
+    pos = actual;
+    return ST_DONE;
+}
+
+/* Copies the ASCII run at the start of the input, 16 bytes at a time where
+   SSE2 is available. Returns the number of bytes copied */
+
+size_t copyAscii( const unsigned char *pos, const unsigned char *end, char32_t *out )
+{
+    const unsigned char *start = pos;
+#if defined( __SSE2__ )
+    const __m128i zero = _mm_setzero_si128();
+    while( end - pos >= 16 ) {
+        __m128i bytes = _mm_loadu_si128(( const __m128i* ) pos );
+        if( _mm_movemask_epi8( bytes ))
+            break;
+        __m128i low = _mm_unpacklo_epi8( bytes, zero );
+        __m128i high = _mm_unpackhi_epi8( bytes, zero );
+        _mm_storeu_si128(( __m128i* ) out, _mm_unpacklo_epi16( low, zero ));
+        _mm_storeu_si128(( __m128i* ) out + 1, _mm_unpackhi_epi16( low, zero ));
+        _mm_storeu_si128(( __m128i* ) out + 2, _mm_unpacklo_epi16( high, zero ));
+        _mm_storeu_si128(( __m128i* ) out + 3, _mm_unpackhi_epi16( high, zero ));
+        pos += 16;
+        out += 16;
+    }
+#endif
+    while( pos < end && *pos < 0x80 )
+        *out++ = *pos++;
+    return pos - start;
+}
+
+} // namespace
+
+const char32_t Utf8Decoder::replacement;
+
+Utf8Decoder::Utf8Decoder() : pendingSize( 0 )
+{
+}
+
+void Utf8Decoder::feed( const char *data, size_t size, std::vector< char32_t > &codepoints )
+{
+    const unsigned char *pos = ( const unsigned char* ) data;
+    const unsigned char *end = pos + size;
+    char32_t codepoint;
+    while( pendingSize && pos < end ) {
+        const int kept = pendingSize;
+        const int added = std::min< size_t >( 4 - pendingSize, end - pos );
+        memcpy( pending + pendingSize, pos, added );
+        const unsigned char *tail = pending;
+        STEP state = step( tail, pending + pendingSize + added, codepoint );
+        if( state == ST_INCOMPLETE ) {
+            pendingSize += added;
+            pos += added;
+            continue;
+        }
+        /* The kept bytes were a valid prefix, so at least those are used */
+        codepoints.push_back( codepoint );
+        pos += ( tail - pending ) - kept;
+        pendingSize = 0;
+    }
+    const size_t first = codepoints.size();
+    codepoints.resize( first + ( end - pos ));
+    char32_t *out = codepoints.data() + first;
+    while( pos < end ) {
+        size_t ascii = copyAscii( pos, end, out );
+        pos += ascii;
+        out += ascii;
+        if( pos == end )
+            break;
+        if( step( pos, end, codepoint ) == ST_INCOMPLETE ) {
+            pendingSize = end - pos;
+            memcpy( pending, pos, pendingSize );
+            break;
+        }
+        *out++ = codepoint;
+    }
+    codepoints.resize( out - codepoints.data() );
+}
+
+void Utf8Decoder::finish( std::vector< char32_t > &codepoints )
+{
+    if( pendingSize )
+        codepoints.push_back( replacement );
+    pendingSize = 0;
+}
+
+void Utf8Decoder::reset()
+{
+    pendingSize = 0;
+}
+
+void Utf8Decoder::decode( const std::string &text, std::vector< char32_t > &codepoints )
+{
+    Utf8Decoder decoder;
+    decoder.feed( text.data(), text.size(), codepoints );
+    decoder.finish( codepoints );
+}
+
+char32_t Utf8Decoder::next( const char *&pos, const char *end )
+{
+    const unsigned char *actual = ( const unsigned char* ) pos;
+    char32_t codepoint;
+    if( step( actual, ( const unsigned char* ) end, codepoint ) == ST_INCOMPLETE ) {
+        pos = end;
+        return replacement;
+    }
+    pos = ( const char* ) actual;
+    return codepoint;
+}
+
+int Utf8Decoder::encode( char32_t codepoint, char *out )
+{
+    if(( codepoint >= 0xd800 && codepoint <= 0xdfff ) || codepoint > 0x10ffff )
+        codepoint = replacement;
+    if( codepoint < 0x80 ) {
+        out[ 0 ] = codepoint;
+        return 1;
+    }
+    if( codepoint < 0x800 ) {
+        out[ 0 ] = 0xc0 | codepoint >> 6;
+        out[ 1 ] = 0x80 | ( codepoint & 0x3f );
+        return 2;
+    }
+    if( codepoint < 0x10000 ) {
+        out[ 0 ] = 0xe0 | codepoint >> 12;
+        out[ 1 ] = 0x80 | ( codepoint >> 6 & 0x3f );
+        out[ 2 ] = 0x80 | ( codepoint & 0x3f );
+        return 3;
+    }
+    out[ 0 ] = 0xf0 | codepoint >> 18;
+    out[ 1 ] = 0x80 | ( codepoint >> 12 & 0x3f );
+    out[ 2 ] = 0x80 | ( codepoint >> 6 & 0x3f );
+    out[ 3 ] = 0x80 | ( codepoint & 0x3f );
+    return 4;
+}
+
+size_t Utf8Decoder::boundary( const std::string &text, size_t pos )
+{
+    return boundary( text.data(), text.size(), pos );
+}
+
+size_t Utf8Decoder::boundary( const char *text, size_t size, size_t pos )
+{
+    if( pos >= size )
+        return size;
+    for( int back = 0; back < 3 && pos > 0 && ( text[ pos ] & 0xc0 ) == 0x80; ++back )
+        --pos;
+    return pos;
+}
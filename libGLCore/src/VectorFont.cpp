@@ -1,30 +1,248 @@
 #include "VectorFont.h"
+#include "Utf8.h"
 #include "GLCore.h"
+#include "Booleans.h"
 #include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#if defined( __SSE__ )
+#include <xmmintrin.h>
+#endif
 
 extern float degToRad;
 
-ZeroX::ZeroX()
+/* True when an edge of one contour properly crosses an edge of the other */
+
+static bool edgesCross( const Face &a, const Face &b )
+{
+    const size_t countA = a.size();
+    const size_t countB = b.size();
+    for( size_t i = 0; i < countA; ++i ) {
+        const Vector2D &a1 = a[ i ];
+        const Vector2D &a2 = a[( i + 1 ) % countA ];
+        for( size_t j = 0; j < countB; ++j ) {
+            const Vector2D &b1 = b[ j ];
+            const Vector2D &b2 = b[( j + 1 ) % countB ];
+            const double o1 = ( double )( a2.x - a1.x ) * ( b1.y - a1.y ) - ( double )( a2.y - a1.y ) * ( b1.x - a1.x );
+            const double o2 = ( double )( a2.x - a1.x ) * ( b2.y - a1.y ) - ( double )( a2.y - a1.y ) * ( b2.x - a1.x );
+            const double o3 = ( double )( b2.x - b1.x ) * ( a1.y - b1.y ) - ( double )( b2.y - b1.y ) * ( a1.x - b1.x );
+            const double o4 = ( double )( b2.x - b1.x ) * ( a2.y - b1.y ) - ( double )( b2.y - b1.y ) * ( a2.x - b1.x );
+            if((( o1 < 0 && o2 > 0 ) || ( o1 > 0 && o2 < 0 )) && (( o3 < 0 && o4 > 0 ) || ( o3 > 0 && o4 < 0 )))
+                return true;
+        }
+    }
+    return false;
+}
+
+/* An outer contour of a grouped set followed by its holes */
+
+static std::vector< size_t > shapeContours( const PolygonSet &polys, size_t outer )
+{
+    std::vector< size_t > contours( 1, outer );
+    for( size_t i = 0; i < polys.contourCount(); ++i ) {
+        if( polys.parents[ i ] == int( outer ))
+            contours.push_back( i );
+    }
+    return contours;
+}
+
+/* Any contour of one outline crossing any contour of the other */
+
+static bool contoursCross( const PolygonSet &polys, size_t a, size_t b )
+{
+    for( size_t contourA : shapeContours( polys, a )) {
+        const Face faceA = polys.face( contourA );
+        for( size_t contourB : shapeContours( polys, b )) {
+            if( edgesCross( faceA, polys.face( contourB )))
+                return true;
+        }
+    }
+    return false;
+}
+
+/* Inside the outline and outside all of its holes */
+
+static bool filledAt( const PolygonSet &polys, size_t outer, const Vector2D &point )
+{
+    if( !FaceBooleans::contains( polys.face( outer ), point ))
+        return false;
+    for( const auto &hole : polys.holes( outer )) {
+        if( FaceBooleans::contains( hole, point ))
+            return false;
+    }
+    return true;
+}
+
+static bool boxesOverlap( const PolygonSet::Box &a, const PolygonSet::Box &b )
+{
+    return b.minx < a.maxx && b.maxx > a.minx && b.miny < a.maxy && b.maxy > a.miny;
+}
+
+/* Outlines of a character overlap when their edges cross, or when one lies
+   in the filled part of another. One inside a hole of another does not */
+
+static bool overlapping( const PolygonSet &polys )
+{
+    for( size_t i = 0; i < polys.contourCount(); ++i ) {
+        if( polys.parents[ i ] >= 0 )
+            continue;
+        for( size_t j = i + 1; j < polys.contourCount(); ++j ) {
+            if( polys.parents[ j ] >= 0 || !boxesOverlap( polys.boxes[ i ], polys.boxes[ j ] ))
+                continue;
+            if( filledAt( polys, i, *polys.contour( j )) || filledAt( polys, j, *polys.contour( i )))
+                return true;
+            if( contoursCross( polys, i, j ))
+                return true;
+        }
+    }
+    return false;
+}
+
+/* Merge overlapping outlines, so the shared parts are not extruded twice */
+
+static PolygonSet mergeContours( const PolygonSet &polys )
+{
+    const bool orientation = FaceGeneators::checkOrientation( polys.face( 0 ));
+    Faces faces;
+    for( size_t i = 0; i < polys.contourCount(); ++i ) {
+        const Face face = polys.face( i );
+        if( polys.parents[ i ] < 0 )
+            faces.push_back( FaceGeneators::checkOrientation( face ) ? face : face.reversed() );
+        else
+            faces.push_back( FaceGeneators::checkOrientation( face ) ? face.reversed() : face );
+    }
+    PolygonSet merged = PolygonSet::fromGrouped( FaceBooleans::group( FaceBooleans::resolve( faces )));
+    for( size_t i = 0; i < merged.contourCount(); ++i ) {
+        if( FaceGeneators::checkOrientation( merged.face( i )) != orientation )
+            merged.reverse( i );
+    }
+    return merged;
+}
+
+/* Mesh cache file layout, the version has to change with it */
+
+static const char cacheMagic[ 8 ] = { 'e', 'C', 'V', 'G', 'L', 'Y', 'P', 'H' };
+static const uint32_t cacheVersion = 2;
+
+/* Below this many vertices a text mesh is not worth spreading over threads */
+
+static const size_t parallelMeshVertices = 1 << 16;
+
+/* FNV-1a hash of the outlines and of everything else the meshes depend on */
+
+static void hashBytes( uint64_t &hash, const void *data, size_t size )
 {
-    first = true;
+    const unsigned char *bytes = ( const unsigned char* ) data;
+    for( size_t i = 0; i < size; ++i )
+        hash = ( hash ^ bytes[ i ] ) * 1099511628211ull;
 }
 
-ZeroX::ZeroX( const ZeroX &other )
+static uint64_t sourceHash( const std::map< long, std::vector<std::vector<std::pair<double,double>>>> &font_src )
 {
-    operator = ( other );
+    uint64_t hash = 14695981039346656037ull;
+    for( const auto &letter : font_src ) {
+        int64_t charID = letter.first;
+        uint64_t polys = letter.second.size();
+        hashBytes( hash, &charID, sizeof( charID ));
+        hashBytes( hash, &polys, sizeof( polys ));
+        for( const auto &poly : letter.second ) {
+            uint64_t points = poly.size();
+            hashBytes( hash, &points, sizeof( points ));
+            for( const auto &point : poly ) {
+                hashBytes( hash, &point.first, sizeof( point.first ));
+                hashBytes( hash, &point.second, sizeof( point.second ));
+            }
+        }
+    }
+    return hash;
+}
+
+static uint64_t cacheKey( uint64_t source, const VectorFont::GlyphStyle &style, bool mergeOverlaps, int kerningSteps )
+{
+    uint64_t hash = 14695981039346656037ull;
+    hashBytes( hash, &cacheVersion, sizeof( cacheVersion ));
+    hashBytes( hash, &style.grow, sizeof( style.grow ));
+    hashBytes( hash, &style.depth, sizeof( style.depth ));
+    hashBytes( hash, &style.bevel, sizeof( style.bevel ));
+    hashBytes( hash, &style.roundStep, sizeof( style.roundStep ));
+    hashBytes( hash, &mergeOverlaps, sizeof( mergeOverlaps ));
+    hashBytes( hash, &kerningSteps, sizeof( kerningSteps ));
+    hashBytes( hash, &source, sizeof( source ));
+    return hash;
+}
+
+/* Bounds checked reader over the mapped cache file. Arrays of plain types
+   are copied at once, vectors are read coordinate by coordinate */
+
+struct CacheReader
+{
+    const unsigned char *pos;
+    const unsigned char *end;
+    template< class T > bool read( T &value ) {
+        if( size_t( end - pos ) < sizeof( T ))
+            return false;
+        memcpy( &value, pos, sizeof( T ));
+        pos += sizeof( T );
+        return true;
+    }
+    bool read( Vector3D &value ) {
+        return read( value.x ) && read( value.y ) && read( value.z );
+    }
+    template< class T > bool read( std::vector< T > &values, size_t count ) {
+        if( size_t( end - pos ) / sizeof( T ) < count )
+            return false;
+        values.resize( count );
+        return readItems( values.data(), count, std::is_trivially_copyable< T >() );
+    }
+private:
+    template< class T > bool readItems( T *values, size_t count, std::true_type ) {
+        memcpy( values, pos, count * sizeof( T ));
+        pos += count * sizeof( T );
+        return true;
+    }
+    template< class T > bool readItems( T *values, size_t count, std::false_type ) {
+        for( size_t i = 0; i < count; ++i ) {
+            if( !read( values[ i ] ))
+                return false;
+        }
+        return true;
+    }
+};
+
+template< class T > static void cacheWrite( std::vector< unsigned char > &out, const T &value )
+{
+    const unsigned char *bytes = ( const unsigned char* ) &value;
+    out.insert( out.end(), bytes, bytes + sizeof( T ));
+}
+
+static void cacheWrite( std::vector< unsigned char > &out, const Vector3D &value )
+{
+    cacheWrite( out, value.x );
+    cacheWrite( out, value.y );
+    cacheWrite( out, value.z );
+}
+
+template< class T > static void cacheWriteItems( std::vector< unsigned char > &out, const std::vector< T > &values, std::true_type )
+{
+    const unsigned char *bytes = ( const unsigned char* ) values.data();
+    out.insert( out.end(), bytes, bytes + values.size() * sizeof( T ));
+}
+
+template< class T > static void cacheWriteItems( std::vector< unsigned char > &out, const std::vector< T > &values, std::false_type )
+{
+    for( const auto &value : values )
+        cacheWrite( out, value );
 }
 
-ZeroX *ZeroX::operator = ( const ZeroX &other )
+template< class T > static void cacheWrite( std::vector< unsigned char > &out, const std::vector< T > &values )
 {
-    leftPos = other.leftPos;
-    rightPos = other.rightPos;
-    angleScales = other.angleScales;
-    dy = other.dy;
-    first = other.first;
-    return this;
+    cacheWriteItems( out, values, std::is_trivially_copyable< T >() );
 }
 
-void ZeroX::setAngles( float angle, int dirsteps )
+KerningAngles::KerningAngles( float angle, int dirsteps )
 {
     float angleStep = 0;
     if( dirsteps )
@@ -35,89 +253,111 @@ void ZeroX::setAngles( float angle, int dirsteps )
         angleScales.push_back( tan( curAngle ));
         scales.push_back( 1 / cos( curAngle ));
     }
+    samples = angleScales.size();
+    while( angleScales.size() % lanes ) {
+        angleScales.push_back( angleScales.back() );
+        scales.push_back( scales.back() );
+    }
 }
 
-void ZeroX::setRange( float minx, float maxx )
+std::shared_ptr< const KerningAngles > KerningAngles::standard()
 {
-    int anglescls = angleScales.size();
-    for( int s = 0; s < anglescls; ++s ) {
-        auto &lpos = leftPos[ s ];
-        auto &rpos = rightPos[ s ];
-        lpos -= minx;
-        rpos -= maxx;
-    }
+    static const std::shared_ptr< const KerningAngles > angles = std::make_shared< const KerningAngles >( 20, 2 );
+    return angles;
 }
 
-float ZeroX::calcPos( float angleScale, const Vector2D &point )
+ZeroX::ZeroX( std::shared_ptr< const KerningAngles > angles ) : angles( angles ), leftPos( angles->angleScales.size(), 0 ),
+    rightPos( angles->angleScales.size(), 0 ), first( true ), dy( 0 )
 {
-    return point.x + angleScale * ( point.y );
 }
 
-float ZeroX::getMin( const ZeroX &previous, float gap )
+void ZeroX::setRange( float minx, float maxx )
 {
-    int anglescls = angleScales.size();
-    float min = 0;
-    bool first = true;
-    for( int s = 0; s < anglescls; ++s ) {
-        const auto &scl = scales[ s ];
-        const auto &lpos = leftPos[ s ];
-        const auto &rpos = previous.rightPos[ s ];
-        float d = ( rpos - lpos ) * 0.8f + /*1.0 * */scl - ( 1 - gap );
-        if( first )
-            min = d;
-        else
-            if( min > d )
-                min = d;
-        first = false;
+    for( size_t s = 0; s < leftPos.size(); ++s ) {
+        leftPos[ s ] -= minx;
+        rightPos[ s ] -= maxx;
     }
-    return min;
 }
 
-void ZeroX::addFace( const Face &face )
+/* Closest approach of two profiles before the gap is applied, four
+   directions per step. The padding lanes repeat the last one */
+
+float ZeroX::getDistance( const ZeroX &previous ) const
 {
-    int anglescls = angleScales.size();
-    if( !leftPos.size() || !rightPos.size() )
-    for( int s = 0; s < anglescls; ++s ) {
-        leftPos.push_back( 0 );
-        rightPos.push_back( 0 );
-    }
-    for( const auto &point : face ) {
-        for( int s = 0; s < anglescls; ++s ) {
-            const auto &angle = angleScales[ s ];
-            auto &lpos = leftPos[ s ];
-            auto &rpos = rightPos[ s ];
-            if( first ) {
-                lpos = calcPos( angle, point );
-                rpos = calcPos( angle, point );
-            } else {
-                float tmpx;
-                tmpx =  calcPos( angle, point );
-                if( lpos > tmpx )
-                    lpos = tmpx;
-                tmpx =  calcPos( angle, point );
-                if( rpos < tmpx )
-                    rpos = tmpx;
-            }
-       }
-       first = false;
+    const size_t count = leftPos.size();
+    const float *scales = angles->scales.data();
+    const float *lpos = leftPos.data();
+    const float *rpos = previous.rightPos.data();
+    float min = std::numeric_limits< float >::max();
+#if defined( __SSE__ )
+    const __m128 factor = _mm_set1_ps( 0.8f );
+    __m128 mins = _mm_set1_ps( min );
+    for( size_t s = 0; s < count; s += KerningAngles::lanes ) {
+        const __m128 d = _mm_add_ps( _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( rpos + s ), _mm_loadu_ps( lpos + s )), factor ),
+            _mm_loadu_ps( scales + s ));
+        mins = _mm_min_ps( mins, d );
     }
+    mins = _mm_min_ps( mins, _mm_movehl_ps( mins, mins ));
+    mins = _mm_min_ss( mins, _mm_shuffle_ps( mins, mins, 1 ));
+    min = _mm_cvtss_f32( mins );
+#else
+    for( size_t s = 0; s < count; ++s ) {
+        float d = ( rpos[ s ] - lpos[ s ] ) * 0.8f + /*1.0 * */scales[ s ];
+        if( min > d )
+            min = d;
+    }
+#endif
+    return min;
 }
 
-KerningSource::KerningSource()
+/* Subtracting the same value keeps the order of the samples, so this is
+   exactly the minimum taken after the subtraction */
+
+float ZeroX::getMin( const ZeroX &previous, float gap ) const
 {
-    zerox.setAngles( 20, 2 );
+    return getDistance( previous ) - ( 1 - gap );
 }
 
-KerningSource::KerningSource( const KerningSource &other ) : KerningSource()
+/* Every point is projected on four directions at once, the extents stay in
+   registers over the whole face */
+
+void ZeroX::addFace( const Face &face )
 {
-    operator = ( other );
+    if( face.empty() )
+        return;
+    const size_t count = leftPos.size();
+    if( first ) {
+        std::fill( leftPos.begin(), leftPos.end(), std::numeric_limits< float >::max() );
+        std::fill( rightPos.begin(), rightPos.end(), -std::numeric_limits< float >::max() );
+        first = false;
+    }
+    const float *angleScales = angles->angleScales.data();
+    for( size_t s = 0; s < count; s += KerningAngles::lanes ) {
+#if defined( __SSE__ )
+        const __m128 angle = _mm_loadu_ps( angleScales + s );
+        __m128 lpos = _mm_loadu_ps( leftPos.data() + s );
+        __m128 rpos = _mm_loadu_ps( rightPos.data() + s );
+        for( const auto &point : face ) {
+            const __m128 pos = _mm_add_ps( _mm_set1_ps( point.x ), _mm_mul_ps( angle, _mm_set1_ps( point.y )));
+            lpos = _mm_min_ps( lpos, pos );
+            rpos = _mm_max_ps( rpos, pos );
+        }
+        _mm_storeu_ps( leftPos.data() + s, lpos );
+        _mm_storeu_ps( rightPos.data() + s, rpos );
+#else
+        for( const auto &point : face ) {
+            for( size_t lane = s; lane < s + KerningAngles::lanes; ++lane ) {
+                const float pos = point.x + angleScales[ lane ] * ( point.y );
+                leftPos[ lane ] = std::min( leftPos[ lane ], pos );
+                rightPos[ lane ] = std::max( rightPos[ lane ], pos );
+            }
+        }
+#endif
+    }
 }
 
-KerningSource *KerningSource::operator = ( const KerningSource &other )
+KerningSource::KerningSource( std::shared_ptr< const KerningAngles > angles ) : zerox( angles )
 {
-    zerox = other.zerox;
-    bBox = other.bBox;
-    return this;
 }
 
 void KerningSource::calc()
@@ -130,326 +370,1154 @@ void KerningSource::addFace( const Face &face )
     zerox.addFace( face );
 }
 
-float KerningSource::getWidth()
+float KerningSource::getWidth() const
 {
     return bBox.maxx - bBox.minx;
 }
 
-float KerningSource::getKerning( KerningSource *prevChar, float gap )
+float KerningSource::getKerning( const KerningSource *prevChar, float gap ) const
 {
     if( prevChar )
         return zerox.getMin( prevChar->zerox, gap );
     return 0;
 }
 
-VectorFont::VectorFont() : gap( 0.32 )
+CodepointTable::CodepointTable()
 {
+    clear();
 }
 
-void VectorFont::Init( std::map< long, std::vector<std::vector<std::pair<double,double>>>> font_src, float grow, float depth, float bevel, int roundStep ) {
-    characters.clear();
-    std::vector< std::pair< long, std::vector< BBoxFace >>> char_srcs;
-    std::shared_ptr<BBoxFace> globalBox;
-    for( auto letter : font_src ) {
-        std::vector< BBoxFace > boxes;
-        for( auto poly : letter.second ) {
-            BBoxFace box;
-            for( auto point : poly ) {
-                box.addPoint( Vector2D( point.first, point.second ));
-            }
-            boxes.push_back( box );
-        }
-        BBoxFace letter_box;
-        letter_box.setBox( boxes.front() );
-        for( auto &box: boxes ) {
-            letter_box.grow( box );
+void CodepointTable::clear()
+{
+    directory.assign( codepointLimit >> pageBits, 0 );
+    pages.assign( pageSize, -1 );
+}
+
+void CodepointTable::insert( long codepoint, int index )
+{
+    if( codepoint < 0 || codepoint >= codepointLimit )
+        return;
+    int32_t &page = directory[ codepoint >> pageBits ];
+    if( !page ) {
+        page = pages.size();
+        pages.resize( pages.size() + pageSize, -1 );
+    }
+    pages[ page + ( codepoint & ( pageSize - 1 )) ] = index;
+}
+
+int CodepointTable::find( long codepoint ) const
+{
+    if( codepoint < 0 || codepoint >= codepointLimit )
+        return -1;
+    return pages[ directory[ codepoint >> pageBits ] + ( codepoint & ( pageSize - 1 )) ];
+}
+
+VectorFont::Glyph::Glyph() : charID( 0 ), width( 0 ), deferred( false )
+{
+}
+
+VectorFont::VectorFont() : minx( 0 ), gap( 0.32 ), mergeOverlaps( true ), workers( 0 ), lazy( false ), keepMeshes( true ), progressive( false ), stopRefining( false ), refinedGlyphs( 0 ), meshVersion( 0 ), restyleReady( false ), profileBuild( false ), kerningSteps( 2 ), sourceKey( 0 ), kerningTableLimit( 1024 ), frozen( false ), layoutLimit( 256 ), layoutUses( 0 ), layoutGap( 0.32 )
+{
+}
+
+VectorFont::~VectorFont()
+{
+    cancelRefining();
+    waitCacheWritten();
+}
+
+static PolygonSet toOutlines( const std::vector<std::vector<std::pair<double,double>>> &contours )
+{
+    PolygonSet outlines;
+    std::vector< Vector2D > points;
+    for( const auto &poly : contours ) {
+        points.clear();
+        for( const auto &point : poly ) {
+            points.push_back( Vector2D( point.first, point.second ));
         }
+
+        /* The source contours run the other way round */
+
+        outlines.reverse( outlines.addContour( points.data(), points.size() ));
+    }
+    return outlines;
+}
+
+void VectorFont::Init( const std::map< long, std::vector<std::vector<std::pair<double,double>>>> &font_src, float grow, float depth, float bevel, int roundStep ) {
+    cancelRefining();
+    waitCacheWritten();
+    refinedGlyphs = 0;
+    ++meshVersion;
+    restyleReady = false;
+    std::vector< GlyphMesh >().swap( restyledMeshes );
+    std::vector< KerningSource >().swap( restyledKerning );
+    std::vector< PolygonSet >().swap( restyledOutlines );
+    std::vector< PolygonSet >().swap( restyledPolys );
+    restyledSource = nullptr;
+    std::vector< Glyph >( font_src.size() ).swap( glyphs );
+    glyphIndex.clear();
+    clearLayouts();
+    frozen = false;
+    resetKerningPairs();
+    style.grow = grow;
+    style.depth = depth;
+    style.bevel = bevel;
+    style.roundStep = roundStep;
+    kerningAngles = kerningSteps == 2 ? KerningAngles::standard() : std::make_shared< const KerningAngles >( 20, kerningSteps );
+    std::shared_ptr<BBoxFace> globalBox;
+    int index = 0;
+    for( const auto &letter : font_src ) {
+        Glyph &glyph = glyphs[ index ];
+        glyph.outlines = toOutlines( letter.second );
+        const PolygonSet::Box bounds = glyph.outlines.bounds();
+        BBoxFace &letter_box = glyph.box;
+        letter_box.minx = bounds.minx;
+        letter_box.miny = bounds.miny;
+        letter_box.maxx = bounds.maxx;
+        letter_box.maxy = bounds.maxy;
         if( globalBox.get() )
             globalBox->grow( letter_box );
         else
             globalBox = std::make_shared<BBoxFace>( letter_box );
-        char_srcs.push_back( std::pair< long, std::vector< BBoxFace >>( letter.first, boxes ));
-        letter_boxes.insert( std::pair< long, BBoxFace >( letter.first, letter_box ));
-    }
-    for( auto &letter: char_srcs ) {
-        std::vector< std::pair< Face, std::vector< Face >>> char_polys;
-        while( letter.second.size() ) {
-            auto &polygons = letter.second;
-            auto &first_poly = polygons.front();
-            int outside = 0;
-            int inbound = 0;
-            int outbound = 0;
-            for( auto &face: letter.second ) {
-                if( &first_poly == &face )
-                    continue;
-                int actrelation = first_poly.checkRelation( face );
-                switch ( actrelation ) {
-                case 0:
-                    ++outside;
-                    break;
-                case -1:
-                    ++outbound;
-                    break;
-                case 1:
-                    ++inbound;
-                    break;
-                default:
-                    break;
-                }
-            }
-            if( !inbound && !outbound ) {
-                char_polys.push_back( std::pair< Face, std::vector< Face >> ( first_poly, std::vector< Face >()));
-                polygons.erase( polygons.begin() );
-            }
-            if( inbound && !outbound ) {
-                std::vector< Face > second_polys;
-                for( auto it = ++polygons.begin(); it != polygons.end(); ) {
-                    auto face = ( *it );
-                    int actrelation = first_poly.checkRelation( face );
-                    if( actrelation == 1 ) {
-                        second_polys.push_back( face );
-                        polygons.erase( it );
-                    } else {
-                        ++it;
-                    }
-                }
-                char_polys.push_back( std::pair< Face, std::vector< Face >> ( first_poly, second_polys ));
-                polygons.erase( polygons.begin() );
-            }
-            if( !inbound && outbound ) {
-                auto poly = first_poly;
-                polygons.erase( polygons.begin() );
-                polygons.push_back( poly );
-            }
-            if( inbound && outbound ) {
-                std::cerr << "in and outbound in same contrext!\n";
-                polygons.erase( polygons.begin() );
+        glyph.charID = letter.first;
+        glyph.width = letter_box.maxx - letter_box.minx;
+        glyphIndex.insert( letter.first, index++ );
+    }
+    minx = globalBox.get() ? globalBox->minx : 0;
+    buildReport.clear();
+    if( profileBuild ) {
+        buildReport.assign( glyphs.size(), GlyphReport() );
+        for( size_t i = 0; i < glyphs.size(); ++i )
+            buildReport[ i ].charID = glyphs[ i ].charID;
+    }
+
+    std::unique_ptr< ThreadPool > ownPool;
+    if( workers > 0 )
+        ownPool.reset( new ThreadPool( workers ));
+    ThreadPool &pool = ownPool ? *ownPool : ThreadPool::global();
+    uint64_t key = 0;
+    bool cached = false;
+    sourceKey = 0;
+    if( keepMeshes && !cachePath.empty() ) {
+        sourceKey = sourceHash( font_src );
+        key = cacheKey( sourceKey, style, mergeOverlaps, kerningSteps );
+        cached = loadCache( key );
+    }
+
+    /* In lazy mode only the outlines are kept, the table never changes shape
+       while glyphs are built on demand. With a cache path set the refiner
+       builds the glyphs not asked for yet and stores the cache. Without kept
+       meshes a build only groups the contours and fills the kerning profile */
+
+    if(( lazy && !cached ) || !keepMeshes ) {
+        for( auto &glyph : glyphs )
+            glyph.deferred = true;
+        resetKerningPairs();
+        if( keepMeshes && !cachePath.empty() )
+            refiner = std::thread( &VectorFont::refine, this, key );
+        return;
+    }
+
+    /* Glyphs are independent and every one owns its slot of the table, so
+       the outcome does not depend on the number of workers. A progressive
+       font stores the cache once refined */
+
+    if( !cached ) {
+        pool.parallelFor( glyphs.size(), [ this ]( size_t i ) {
+            Glyph &glyph = glyphs[ i ];
+            GlyphBuild build = buildGlyph( glyph.charID, glyph.outlines, !progressive );
+            glyph.polys = std::move( build.polys );
+            if( progressive ) {
+                BuildProfile::Scope scope( &build.report.stages );
+                build.mesh = extrudeGlyph( glyph.polys, draftStyle() );
             }
+            glyph.mesh = std::make_shared< const Triangles >( std::move( build.mesh ));
+            glyph.kerning = build.kerning;
+            if( profileBuild )
+                recordBuild( i, build.report );
+        } );
+        if( progressive )
+            refiner = std::thread( &VectorFont::refine, this, key );
+        else if( !cachePath.empty() )
+            writeCache( key );
+    }
+    if( cached && profileBuild ) {
+        for( size_t i = 0; i < glyphs.size(); ++i )
+            recordBuild( i, GlyphReport() );
+    }
+    fillKerningPairs( pool );
+}
+
+/* Each refined mesh replaces a draft with one atomic store, texts still
+   holding the draft keep it alive. Deferred glyphs are built instead, the
+   ones already built on demand are left as they are. A cancelled
+   refinement stores no cache */
+
+void VectorFont::refine( uint64_t key ) {
+    std::unique_ptr< ThreadPool > ownPool;
+    if( workers > 0 )
+        ownPool.reset( new ThreadPool( workers ));
+    ThreadPool &pool = ownPool ? *ownPool : ThreadPool::global();
+    pool.parallelFor( glyphs.size(), [ this ]( size_t i ) {
+        if( stopRefining )
+            return;
+        if( glyphs[ i ].deferred ) {
+            ensureGlyph( glyphs[ i ] );
+            ++refinedGlyphs;
+            return;
         }
-        characters.insert( std::pair< long, std::vector< std::pair< Face, std::vector< Face >>>>( letter.first, char_polys ));
-        Triangles letter3D;
-        for( auto poly : char_polys ) {
-            letter3D += TriangleGeneators::bevelExtrude( poly.first, poly.second, depth, bevel, roundStep, true, true ).optimized();
-        }
-        letters.insert( std::pair<long, Triangles >( letter.first, letter3D ));
-    }
-    for( auto &letter: characters ) {
-        KerningSource kerning;
-        kerning.zerox.dy = globalBox->minx;
-        for( auto &face: letter.second ) {
-            if( grow )
-                kerning.addFace( FaceGeneators::grow( face.first, grow ));
-            else
-                kerning.addFace( face.first );
+        GlyphReport report = GlyphReport();
+        BuildProfile::Scope scope( &report.stages );
+        GlyphMesh mesh = std::make_shared< const Triangles >( extrudeGlyph( glyphs[ i ].polys ));
+        std::atomic_store( &glyphs[ i ].mesh, mesh );
+        ++meshVersion;
+        if( profileBuild )
+            recordBuild( i, report );
+        ++refinedGlyphs;
+    } );
+    if( !stopRefining && !cachePath.empty() )
+        writeCache( key );
+}
+
+/* Starts extruding the glyphs in a new style, replacing a restyle not yet
+   applied. The contours are needed, so a compacted font or one without
+   kept meshes can not be restyled */
+
+bool VectorFont::restyle( const GlyphStyle &next ) {
+    if( frozen || !keepMeshes || glyphs.empty() )
+        return false;
+    cancelRefining();
+    beginRestyle( next );
+    refiner = std::thread( &VectorFont::rebuildStyle, this );
+    return true;
+}
+
+/* Called with no refiner running, prepares the slots of the new set */
+
+void VectorFont::beginRestyle( const GlyphStyle &next ) {
+    restyleReady = false;
+    restyledStyle = next;
+    restyledMeshes.assign( glyphs.size(), GlyphMesh() );
+    restyledKerning.clear();
+    if( next.grow != style.grow )
+        restyledKerning.resize( glyphs.size() );
+    restyledPolys.assign( glyphs.size(), PolygonSet() );
+}
+
+/* New outlines of the same characters, like curves flattened for another
+   size, are extruded in the current style or the one of a pending restyle.
+   The boxes and the kerning stay those of the first outlines, so laid out
+   text does not move. Characters missing from font_src keep their outlines */
+
+bool VectorFont::reflatten( const std::map< long, std::vector<std::vector<std::pair<double,double>>>> &font_src ) {
+    if( frozen || !keepMeshes || glyphs.empty() )
+        return false;
+    const GlyphStyle next = restyledMeshes.empty() ? style : restyledStyle;
+    cancelRefining();
+    restyledSource = nullptr;
+    takeOutlines( font_src );
+    beginRestyle( next );
+    refiner = std::thread( &VectorFont::rebuildStyle, this );
+    return true;
+}
+
+/* Decoding the outlines may take as long as extruding them, so source is
+   called on the refiner thread too. It has to stay valid until the restyle
+   is applied or the font is initialized again */
+
+bool VectorFont::reflatten( const std::function< std::map< long, std::vector<std::vector<std::pair<double,double>>>>() > &source ) {
+    if( frozen || !keepMeshes || glyphs.empty() )
+        return false;
+    const GlyphStyle next = restyledMeshes.empty() ? style : restyledStyle;
+    cancelRefining();
+    restyledSource = source;
+    beginRestyle( next );
+    refiner = std::thread( &VectorFont::rebuildStyle, this );
+    return true;
+}
+
+/* Characters missing from font_src keep the outlines of a reflatten still
+   pending, or their current ones */
+
+void VectorFont::takeOutlines( const std::map< long, std::vector<std::vector<std::pair<double,double>>>> &font_src ) {
+    restyledOutlines.resize( glyphs.size() );
+    for( size_t i = 0; i < glyphs.size(); ++i ) {
+        auto found = font_src.find( glyphs[ i ].charID );
+        if( found != font_src.end() )
+            restyledOutlines[ i ] = toOutlines( found->second );
+        else if( restyledOutlines[ i ].isEmpty() )
+            restyledOutlines[ i ] = glyphs[ i ].outlines;
+    }
+}
+
+void VectorFont::rebuildStyle() {
+    if( restyledSource ) {
+        const std::map< long, std::vector<std::vector<std::pair<double,double>>>> font_src = restyledSource();
+        if( stopRefining )
+            return;
+        takeOutlines( font_src );
+        restyledSource = nullptr;
+    }
+    std::unique_ptr< ThreadPool > ownPool;
+    if( workers > 0 )
+        ownPool.reset( new ThreadPool( workers ));
+    ThreadPool &pool = ownPool ? *ownPool : ThreadPool::global();
+    pool.parallelFor( glyphs.size(), [ this ]( size_t i ) {
+        if( stopRefining )
+            return;
+        Glyph &glyph = glyphs[ i ];
+        ensureGlyph( glyph );
+
+        /* A glyph loaded from the cache has its mesh and kerning but no
+           contours yet, they are grouped here and kept with the new mesh */
+
+        PolygonSet grouped;
+        if( glyph.polys.isEmpty() )
+            grouped = groupContours( glyph.outlines );
+        const PolygonSet &polys = glyph.polys.isEmpty() ? grouped : glyph.polys;
+        if( !restyledOutlines.empty() )
+            restyledPolys[ i ] = groupContours( restyledOutlines[ i ] );
+        else if( glyph.polys.isEmpty() )
+            restyledPolys[ i ] = grouped;
+        restyledMeshes[ i ] = std::make_shared< const Triangles >( extrudeGlyph( restyledOutlines.empty() ? polys : restyledPolys[ i ], restyledStyle ));
+        if( !restyledKerning.empty() )
+            restyledKerning[ i ] = glyphKerning( glyph.charID, polys, restyledStyle.grow );
+    } );
+    if( !stopRefining )
+        restyleReady = true;
+}
+
+/* Called between frames, when no other thread uses the font. Layouts made
+   before a change of grow are out of date and have to be redone */
+
+bool VectorFont::applyRestyle() {
+    if( !restyleReady )
+        return false;
+    waitRefined();
+    waitCacheWritten();
+    restyleReady = false;
+    for( size_t i = 0; i < glyphs.size(); ++i ) {
+        std::atomic_store( &glyphs[ i ].mesh, restyledMeshes[ i ] );
+        if( !restyledKerning.empty() )
+            glyphs[ i ].kerning = std::move( restyledKerning[ i ] );
+        if( !restyledOutlines.empty() ) {
+            glyphs[ i ].outlines = std::move( restyledOutlines[ i ] );
+            glyphs[ i ].polys = std::move( restyledPolys[ i ] );
+        } else if( !restyledPolys[ i ].isEmpty() ) {
+            glyphs[ i ].polys = std::move( restyledPolys[ i ] );
         }
-        auto &box = letter_boxes.at(( wchar_t ) letter.first );
-        kerning.bBox = box;
-        kerning.calc();
-        kernings.insert( std::pair< long, KerningSource >( letter.first, kerning ));
     }
+    ++meshVersion;
+    updatePicking();
+    style = restyledStyle;
+    if( !restyledKerning.empty() ) {
+        if( kerningTable.empty() )
+            resetKerningPairs();
+        else
+            fillKerningPairs( ThreadPool::global() );
+        clearLayouts();
+    }
+    std::vector< GlyphMesh >().swap( restyledMeshes );
+    std::vector< KerningSource >().swap( restyledKerning );
+    if( !restyledOutlines.empty() )
+        sourceKey = 0;
+    std::vector< PolygonSet >().swap( restyledOutlines );
+    std::vector< PolygonSet >().swap( restyledPolys );
+
+    /* Every glyph has its final mesh now, even when the restyle cancelled a
+       refine. That refine never stored the cache, so the meshes of the new
+       style are stored instead. Kerning kept from older outlines would not
+       match a fresh build, so a reflattened font stores none */
+
+    refinedGlyphs = glyphs.size();
+    if( sourceKey && !cachePath.empty() )
+        cacheWriter = std::thread( &VectorFont::writeCache, this, cacheKey( sourceKey, style, mergeOverlaps, kerningSteps ));
+    return true;
 }
 
-unsigned long VectorFont::fromUTF8( unsigned long narrow ) {
-    if (( narrow & 0xc0e0 ) == 0x80c0 ) {
-        return (( narrow & 0x3f00 ) >> 8 | ( narrow & 0x1f ) << 6 );
+bool VectorFont::isRefined() const {
+    return !refiner.joinable() || refinedGlyphs == glyphs.size();
+}
+
+void VectorFont::waitRefined() {
+    if( refiner.joinable() )
+        refiner.join();
+}
+
+void VectorFont::cancelRefining() {
+    stopRefining = true;
+    waitRefined();
+    stopRefining = false;
+}
+
+void VectorFont::waitCacheWritten() {
+    if( cacheWriter.joinable() )
+        cacheWriter.join();
+}
+
+VectorFont::GlyphMesh VectorFont::glyphMesh( int index ) const {
+    GlyphMesh mesh = std::atomic_load( &glyphs[ index ].mesh );
+    if( mesh || keepMeshes )
+        return mesh;
+    if( meshSource )
+        return meshSource( index );
+    return std::make_shared< const Triangles >( extrudeGlyph( readyGlyph( index ).polys ));
+}
+
+float VectorFont::GlyphReport::total() const {
+    return groupMicros + kerningMicros + stages.total();
+}
+
+/* Adds the times of a build of the glyph and takes the counts of its
+   outlines and current mesh */
+
+void VectorFont::recordBuild( size_t index, const GlyphReport &report ) const {
+    const Glyph &glyph = glyphs[ index ];
+    GlyphReport &entry = buildReport[ index ];
+    entry.charID = glyph.charID;
+    entry.contours = glyph.outlines.contourCount();
+    entry.points = glyph.outlines.points.size();
+    const GlyphMesh mesh = std::atomic_load( &glyph.mesh );
+    entry.vertices = mesh ? mesh->mVertices.size() : 0;
+    entry.triangles = mesh ? mesh->mIndices.size() / 3 : 0;
+    entry.bytes = mesh ? sizeof( Triangles ) + ( mesh->mVertices.size() + mesh->mNormals.size() ) * sizeof( Vector3D ) + mesh->mIndices.size() * sizeof( uint ) : 0;
+    entry.groupMicros += report.groupMicros;
+    entry.kerningMicros += report.kerningMicros;
+    for( int stage = 0; stage < BuildProfile::StageCount; ++stage )
+        entry.stages.micros[ stage ] += report.stages.micros[ stage ];
+}
+
+static const char *reportColumns = "charID,contours,points,vertices,triangles,bytes,group,kerning,drill,fillFace,bevel,cylinder,optimized,total";
+
+static string reportLine( const VectorFont::GlyphReport &entry, bool json )
+{
+    const float *stages = entry.stages.micros;
+    char line[ 512 ];
+    if( json )
+        snprintf( line, sizeof( line ), "{\"charID\":%ld,\"contours\":%zu,\"points\":%zu,\"vertices\":%zu,\"triangles\":%zu,\"bytes\":%zu,"
+                  "\"group\":%.1f,\"kerning\":%.1f,\"drill\":%.1f,\"fillFace\":%.1f,\"bevel\":%.1f,\"cylinder\":%.1f,\"optimized\":%.1f,\"total\":%.1f}",
+                  entry.charID, entry.contours, entry.points, entry.vertices, entry.triangles, entry.bytes, entry.groupMicros, entry.kerningMicros,
+                  stages[ BuildProfile::Drill ], stages[ BuildProfile::FillFace ], stages[ BuildProfile::Bevel ], stages[ BuildProfile::Cylinder ],
+                  stages[ BuildProfile::Optimize ], entry.total() );
+    else
+        snprintf( line, sizeof( line ), "%ld,%zu,%zu,%zu,%zu,%zu,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f",
+                  entry.charID, entry.contours, entry.points, entry.vertices, entry.triangles, entry.bytes, entry.groupMicros, entry.kerningMicros,
+                  stages[ BuildProfile::Drill ], stages[ BuildProfile::FillFace ], stages[ BuildProfile::Bevel ], stages[ BuildProfile::Cylinder ],
+                  stages[ BuildProfile::Optimize ], entry.total() );
+    return line;
+}
+
+/* Times are in microseconds. The log ends with the total and the slowest
+   glyph */
+
+void VectorFont::logBuildReport() const {
+    if( buildReport.empty() )
+        return;
+    log_message( "Glyph build: %s\n", reportColumns );
+    const GlyphReport *slowest = &buildReport.front();
+    float total = 0;
+    for( const auto &entry : buildReport ) {
+        log_message( "Glyph build: %s\n", reportLine( entry, false ).c_str() );
+        total += entry.total();
+        if( entry.total() > slowest->total() )
+            slowest = &entry;
     }
-    if (( narrow & 0xc0c0f0 ) == 0x8080e0 ) {
-        return (( narrow & 0x3f0000 ) >> 16 | ( narrow & 0x3f00 ) >> 2 | ( narrow & 0x1f ) << 12 );
+    log_message( "Glyph build: %zu glyphs in %.0f us, slowest U+%04lX in %.0f us\n", buildReport.size(), total, slowest->charID, slowest->total() );
+}
+
+/* A path ending in .json gets an array of objects, any other one CSV */
+
+bool VectorFont::saveBuildReport( const string &path ) const {
+    const bool json = path.size() >= 5 && !path.compare( path.size() - 5, 5, ".json" );
+    FILE *file = fopen( path.c_str(), "w" );
+    if( !file )
+        return false;
+    bool written = fprintf( file, json ? "[\n" : "%s\n", reportColumns ) > 0;
+    for( size_t i = 0; i < buildReport.size(); ++i ) {
+        const char *separator = json ? ( i + 1 < buildReport.size() ? ",\n" : "\n" ) : "\n";
+        written = fprintf( file, "%s%s", reportLine( buildReport[ i ], json ).c_str(), separator ) > 0 && written;
     }
-    return narrow & 0x7f;
+    if( json )
+        written = fprintf( file, "]\n" ) > 0 && written;
+    return !fclose( file ) && written;
 }
 
-unsigned long VectorFont::toUTF8( unsigned long wide ) {
-    if ( wide < 0x80 ) {
-        return wide;
-    } else if ( wide < 0x1000 ) {
-        return ( wide & 0xfc0 ) >> 6 | ( wide & 0x3f ) << 6 | 0xc080;
-    } else if ( wide < 0x20000 ) {
-        return ( wide & 0x1f000 ) >> 12 | ( wide & 0xfc0 ) << 2 | ( wide & 0x3f ) << 16  | 0x8080e0;
+/* The kerning pair table is filled up front when every glyph is built, in
+   lazy mode pairs are computed on first use until compact fills the table.
+   Above kerningTableLimit glyphs the pairs stay in the map */
+
+void VectorFont::fillKerningPairs( ThreadPool &pool ) {
+    resetKerningPairs();
+    const size_t count = glyphs.size();
+    if( count > kerningTableLimit )
+        return;
+    std::vector< float > table( count * count );
+    pool.parallelFor( count, [ this, count, &table ]( size_t previous ) {
+        for( size_t next = 0; next < count; ++next )
+            table[ previous * count + next ] = glyphs[ next ].kerning.zerox.getDistance( glyphs[ previous ].kerning.zerox );
+    } );
+    kerningTable.swap( table );
+}
+
+void VectorFont::resetKerningPairs() {
+    std::vector< float >().swap( kerningTable );
+    std::unique_lock< std::mutex > lock( kerningMutex );
+    std::unordered_map< uint64_t, float >().swap( kerningPairs );
+}
+
+/* A deferred glyph is filled once under its own flag. That makes building it
+   a cache fill, which const readers on any thread may trigger */
+
+const VectorFont::Glyph &VectorFont::readyGlyph( int index ) const {
+    const Glyph &glyph = glyphs[ index ];
+    ensureGlyph( glyph );
+    return glyph;
+}
+
+float VectorFont::pairKerning( int previous, int next ) const {
+    if( previous < 0 )
+        return 0;
+    if( !kerningTable.empty() )
+        return kerningTable[ previous * glyphs.size() + next ] - ( 1 - gap );
+    const uint64_t key = uint64_t( previous ) << 32 | uint32_t( next );
+    {
+        std::unique_lock< std::mutex > lock( kerningMutex );
+        auto found = kerningPairs.find( key );
+        if( found != kerningPairs.end() )
+            return found->second - ( 1 - gap );
     }
-    return 0;
+    const float distance = glyphs[ next ].kerning.zerox.getDistance( glyphs[ previous ].kerning.zerox );
+    std::unique_lock< std::mutex > lock( kerningMutex );
+    kerningPairs.insert( std::make_pair( key, distance ));
+    return distance - ( 1 - gap );
 }
 
-int VectorFont::UTF8len( unsigned long narrow ) {
-    if (( narrow & 0x80 ) == 0x00 ) {
-        return 1;
-    } else if (( narrow & 0xc0e0 ) == 0x80c0 ) {
-        return 2;
-    } if (( narrow & 0xc0c0f0 ) == 0x8080e0 ) {
-        return 3;
+size_t VectorFont::MemoryReport::total() const {
+    return outlines + contours + kerning + meshes + picking + layouts + tables;
+}
+
+template< class T > static size_t capacityBytes( const std::vector< T > &values )
+{
+    return values.capacity() * sizeof( T );
+}
+
+VectorFont::MemoryReport VectorFont::memoryReport() const {
+    MemoryReport report = MemoryReport();
+    report.tables = capacityBytes( glyphs ) + capacityBytes( glyphIndex.directory ) + capacityBytes( glyphIndex.pages );
+    report.kerning = capacityBytes( kerningTable );
+    {
+        std::unique_lock< std::mutex > lock( kerningMutex );
+        report.kerning += kerningPairs.bucket_count() * sizeof( void* ) + kerningPairs.size() * ( sizeof( std::pair< uint64_t, float > ) + sizeof( void* ));
+    }
+    for( const auto &glyph : glyphs ) {
+        const GlyphMesh mesh = std::atomic_load( &glyph.mesh );
+        const PolygonSet &outlines = glyph.outlines;
+        report.outlines += capacityBytes( outlines.points ) + capacityBytes( outlines.offsets ) + capacityBytes( outlines.parents ) + capacityBytes( outlines.boxes );
+        report.contours += capacityBytes( glyph.polys.points ) + capacityBytes( glyph.polys.offsets ) + capacityBytes( glyph.polys.parents ) +
+                           capacityBytes( glyph.polys.boxes );
+        report.kerning += capacityBytes( glyph.kerning.zerox.leftPos ) + capacityBytes( glyph.kerning.zerox.rightPos ) + capacityBytes( glyph.kerning.bBox );
+        if( mesh )
+            report.meshes += sizeof( Triangles ) + capacityBytes( mesh->mVertices ) + capacityBytes( mesh->mNormals ) + capacityBytes( mesh->mIndices );
+        report.picking += capacityBytes( glyph.picking.bvh.tree.nodes ) + capacityBytes( glyph.picking.bvh.tree.items );
     }
-    return 4;
+    std::unique_lock< std::mutex > lock( layoutMutex );
+    for( const auto &layout : layouts )
+        report.layouts += layout.first.capacity() + sizeof( Layout ) + capacityBytes( *layout.second.placements );
+    return report;
 }
 
-VectorFont::Text3D VectorFont::genTextChars( string text ) {
-    Faces holes;
-    Text3D chars3D;
-    float xpos = 0;
-    float ypos = 0;
-    Text3D line;
-    KerningSource *prevKerning = 0;
-    for( size_t chrpos = 0; chrpos < text.size(); ) {
-        unsigned long narrow = 0;
-        text.copy(( char* ) &narrow, 4, chrpos );
-        wchar_t charID = narrow & 0xff;
-        int utf8len = UTF8len( narrow );
-        switch( utf8len ) {
-        case 2:
-            charID = fromUTF8( narrow );
-            break;
-        case 3:
-            charID = fromUTF8( narrow );
-            break;
-        default:
-            break;
-        }
-        chrpos += utf8len;
-        holes.clear();
-        if( charID == ' ' ) {
-            xpos += 0.8;
-            continue;
+void VectorFont::logMemory( const char *title ) const {
+    const MemoryReport report = memoryReport();
+    log_message( "%s: outlines %zu, contours %zu, kerning %zu, meshes %zu, picking %zu, layouts %zu, tables %zu, total %zu bytes\n", title,
+                 report.outlines, report.contours, report.kerning, report.meshes, report.picking, report.layouts, report.tables, report.total() );
+}
+
+/* Builds what is still deferred, then keeps only what layout and drawing
+   read: the kerning of every pair goes to a flat table and the outlines and
+   profiles are dropped. Without a table the profiles stay for the map. Contours stay when meshes are left to an owner, who
+   extrudes them. A distance field atlas has to be built before, and no
+   other thread may use the font meanwhile */
+
+void VectorFont::compact( ThreadPool *pool ) {
+    waitRefined();
+    waitCacheWritten();
+    logMemory( "Font before compact" );
+    std::unique_ptr< ThreadPool > ownPool;
+    if( !pool && workers > 0 )
+        ownPool.reset( new ThreadPool( workers ));
+    ThreadPool &threads = pool ? *pool : ownPool ? *ownPool : ThreadPool::global();
+    const size_t count = glyphs.size();
+    threads.parallelFor( count, [ this ]( size_t i ) {
+        ensureGlyph( glyphs[ i ] );
+    } );
+    if( kerningTable.empty() )
+        fillKerningPairs( threads );
+    frozen = true;
+    for( auto &glyph : glyphs ) {
+        glyph.outlines = PolygonSet();
+        if( !kerningTable.empty() ) {
+            std::vector< float >().swap( glyph.kerning.zerox.leftPos );
+            std::vector< float >().swap( glyph.kerning.zerox.rightPos );
         }
-        if( charID == '\n' ) {
-            if( line.size() ) {
-                for( auto letter : line ) {
-                    letter->pos += Vector3D( -xpos * 0.5, ypos, 0 );
-                    chars3D.push_back( letter );
-                }
+        if( keepMeshes )
+            glyph.polys = PolygonSet();
+        else
+            glyph.polys.shrinkToFit();
+
+        /* Meshes are immutable and shared, a tight copy replaces a loose one.
+           A picking hierarchy moves to the copy, its triangles are the same */
+
+        const Triangles *mesh = glyph.mesh.get();
+        if( mesh && ( mesh->mVertices.capacity() > mesh->mVertices.size() || mesh->mNormals.capacity() > mesh->mNormals.size() ||
+                      mesh->mIndices.capacity() > mesh->mIndices.size() )) {
+            glyph.mesh = std::make_shared< const Triangles >( *mesh );
+            ++meshVersion;
+            if( glyph.picking.mesh.get() == mesh ) {
+                glyph.picking.mesh = glyph.mesh;
+                glyph.picking.bvh.mesh = glyph.mesh.get();
             }
-            line.clear();
-            xpos = 0;
-            ypos -= 3.0;
-            continue;
         }
+    }
+    glyphIndex.pages.shrink_to_fit();
+    logMemory( "Font after compact" );
+}
 
-        if( letters.find( charID ) == letters.end() ) // char not available
-            continue;
-        std::shared_ptr< Char3D> letter = std::make_shared< Char3D >();
-        letter->geometry = letters.at( charID );
-        auto &kerning = kernings.at( charID );
-        xpos += kerning.getKerning( prevKerning, gap );
-        letter->pos = Vector3D( xpos, 0, 0 );
-        line.push_back( letter );
-
-        xpos += kerning.getWidth();
-        prevKerning = &kerning;
-    }
-    for( auto letter : line ) {
-        letter->pos += Vector3D( -xpos * 0.5, ypos, 0 );
-        chars3D.push_back( letter );
+bool VectorFont::loadCache( uint64_t key ) {
+    MappedFile file;
+    if( !file.open( cachePath.c_str() ))
+        return false;
+    CacheReader reader = { file.data, file.data + file.size };
+    char magic[ 8 ];
+    uint32_t version;
+    uint64_t fileKey;
+    uint32_t glyphs;
+    uint32_t angles;
+    if( !reader.read( magic ) || memcmp( magic, cacheMagic, sizeof( magic )) || !reader.read( version ) || version != cacheVersion ||
+        !reader.read( fileKey ) || fileKey != key || !reader.read( glyphs ) || !reader.read( angles ))
+        return false;
+    if( glyphs != this->glyphs.size() )
+        return false;
+    std::vector< GlyphMesh > cachedMeshes( glyphs );
+    std::vector< KerningSource > cachedKernings( glyphs );
+    for( uint32_t i = 0; i < glyphs; ++i ) {
+        int64_t charID;
+        uint32_t vertices;
+        uint32_t indices;
+        Triangles mesh;
+        KerningSource kerning( kerningAngles );
+        if( !reader.read( charID ) || !reader.read( vertices ) || !reader.read( indices ) ||
+            !reader.read( mesh.mVertices, vertices ) || !reader.read( mesh.mNormals, vertices ) || !reader.read( mesh.mIndices, indices ) ||
+            !reader.read( kerning.zerox.leftPos, angles ) || !reader.read( kerning.zerox.rightPos, angles ) || !reader.read( kerning.zerox.dy ))
+            return false;
+        const int index = glyphIndex.find( charID );
+        if( index < 0 || cachedMeshes[ index ] || kerningAngles->angleScales.size() != angles )
+            return false;
+        for( auto index : mesh.mIndices ) {
+            if( index >= vertices )
+                return false;
+        }
+        kerning.zerox.first = false;
+        kerning.bBox = this->glyphs[ index ].box;
+        cachedMeshes[ index ] = std::make_shared< const Triangles >( std::move( mesh ));
+        cachedKernings[ index ] = kerning;
     }
-    return chars3D;
+    if( reader.pos != reader.end )
+        return false;
+    for( uint32_t i = 0; i < glyphs; ++i ) {
+        this->glyphs[ i ].mesh = std::move( cachedMeshes[ i ] );
+        this->glyphs[ i ].kerning = cachedKernings[ i ];
+    }
+    return true;
 }
 
-Triangles VectorFont::genText( string text ) {
-    Faces holes;
-    Triangles text3D;
-    Triangles intertext;
-    float xpos = 0;
-    float ypos = 0;
-    KerningSource *prevKerning = 0;
-    for( size_t chrpos = 0; chrpos < text.size(); ) {
-        unsigned long narrow = 0;
-        text.copy(( char* ) &narrow, 4, chrpos );
-        wchar_t charID = narrow & 0xff;
-        int utf8len = UTF8len( narrow );
-        switch( utf8len ) {
-        case 2:
-            charID = fromUTF8( narrow );
-            break;
-        case 3:
-            charID = fromUTF8( narrow );
-            break;
-        default:
-            break;
+void VectorFont::writeCache( uint64_t key ) const {
+    if( !saveCache( key ))
+        log_message( "Could not write glyph cache %s\n", cachePath.c_str() );
+}
+
+bool VectorFont::saveCache( uint64_t key ) const {
+    std::vector< unsigned char > out;
+    const uint32_t angles = glyphs.empty() ? 0 : glyphs.front().kerning.zerox.leftPos.size();
+    out.insert( out.end(), cacheMagic, cacheMagic + sizeof( cacheMagic ));
+    cacheWrite( out, cacheVersion );
+    cacheWrite( out, key );
+    cacheWrite( out, uint32_t( glyphs.size() ));
+    cacheWrite( out, angles );
+    for( const auto &glyph : glyphs ) {
+        const ZeroX &zerox = glyph.kerning.zerox;
+        const Triangles &mesh = *glyph.mesh;
+        if( zerox.leftPos.size() != angles || zerox.rightPos.size() != angles || mesh.mNormals.size() != mesh.mVertices.size() )
+            return false;
+        cacheWrite( out, int64_t( glyph.charID ));
+        cacheWrite( out, uint32_t( mesh.mVertices.size() ));
+        cacheWrite( out, uint32_t( mesh.mIndices.size() ));
+        cacheWrite( out, mesh.mVertices );
+        cacheWrite( out, mesh.mNormals );
+        cacheWrite( out, mesh.mIndices );
+        cacheWrite( out, zerox.leftPos );
+        cacheWrite( out, zerox.rightPos );
+        cacheWrite( out, zerox.dy );
+    }
+    const string temp = cachePath + ".tmp";
+    FILE *file = fopen( temp.c_str(), "wb" );
+    if( !file )
+        return false;
+    bool written = fwrite( out.data(), 1, out.size(), file ) == out.size();
+    written = !fclose( file ) && written;
+    if( !written || rename( temp.c_str(), cachePath.c_str() )) {
+        remove( temp.c_str() );
+        return false;
+    }
+    return true;
+}
+
+VectorFont::Glyph *VectorFont::findGlyph( long charID ) {
+    const int index = glyphIndex.find( charID );
+    return index < 0 ? nullptr : &glyphs[ index ];
+}
+
+void VectorFont::ensureGlyph( long charID ) {
+    Glyph *glyph = findGlyph( charID );
+    if( glyph )
+        ensureGlyph( *glyph );
+}
+
+void VectorFont::ensureGlyph( const Glyph &glyph ) const {
+    if( !glyph.deferred )
+        return;
+    std::call_once( glyph.built, [ this, &glyph ] {
+        GlyphBuild build = buildGlyph( glyph.charID, glyph.outlines, keepMeshes );
+        glyph.polys = std::move( build.polys );
+        if( keepMeshes )
+            std::atomic_store( &glyph.mesh, std::make_shared< const Triangles >( std::move( build.mesh )));
+        glyph.kerning = build.kerning;
+        if( profileBuild )
+            recordBuild( &glyph - glyphs.data(), build.report );
+    } );
+}
+
+/* Called on the thread that picks, between frames. A picking hierarchy
+   built over a mesh since replaced is built again in place */
+
+void VectorFont::updatePicking() {
+    for( auto &glyph : glyphs ) {
+        const GlyphMesh mesh = std::atomic_load( &glyph.mesh );
+        if( mesh && glyph.picking.mesh && glyph.picking.mesh != mesh ) {
+            glyph.picking.mesh = mesh;
+            glyph.picking.bvh.build( *mesh, &ThreadPool::global() );
         }
-        chrpos += utf8len;
-        holes.clear();
-        if( charID == ' ' ) {
-            xpos += 0.8;
-            continue;
+    }
+}
+
+/* Without kept meshes the hierarchy holds the mesh it was built from, which
+   keeps it alive after an owner like GlyphCache dropped it. A character
+   missing from the font gets an empty hierarchy, nothing hits it */
+
+const MeshBVH &VectorFont::glyphBVH( long charID ) {
+    static const MeshBVH none;
+    Glyph *found = findGlyph( charID );
+    if( !found )
+        return none;
+    Glyph &glyph = *found;
+    ensureGlyph( glyph );
+    std::call_once( glyph.picking.once, [ this, &glyph ] {
+        glyph.picking.mesh = glyphMesh( &glyph - glyphs.data() );
+        if( glyph.picking.mesh )
+            glyph.picking.bvh.build( *glyph.picking.mesh, &ThreadPool::global() );
+    } );
+    return glyph.picking.bvh;
+}
+
+void VectorFont::warm( const string &text ) {
+    std::vector< char32_t > codepoints;
+    Utf8Decoder::decode( text, codepoints );
+    std::vector< Glyph* > deferred;
+    for( long charID : codepoints ) {
+        Glyph *glyph = findGlyph( charID );
+        if( glyph && glyph->deferred && std::find( deferred.begin(), deferred.end(), glyph ) == deferred.end() )
+            deferred.push_back( glyph );
+    }
+    std::unique_ptr< ThreadPool > ownPool;
+    if( workers > 0 )
+        ownPool.reset( new ThreadPool( workers ));
+    ThreadPool &pool = ownPool ? *ownPool : ThreadPool::global();
+    pool.parallelFor( deferred.size(), [ this, &deferred ]( size_t i ) {
+        ensureGlyph( *deferred[ i ] );
+    } );
+}
+
+/* Groups the outlines of a glyph into outer contours with their holes. Every
+   outer contour is followed by its holes, which point back at it */
+
+PolygonSet VectorFont::groupContours( const PolygonSet &outlines ) const {
+    PolygonSet char_polys;
+    std::vector< BBoxFace > polygons;
+    polygons.reserve( outlines.contourCount() );
+    for( size_t i = 0; i < outlines.contourCount(); ++i )
+        polygons.push_back( outlines.boxFace( i ));
+    while( polygons.size() ) {
+        auto &first_poly = polygons.front();
+        int outside = 0;
+        int inbound = 0;
+        int outbound = 0;
+        for( auto &face: polygons ) {
+            if( &first_poly == &face )
+                continue;
+            int actrelation = first_poly.checkRelation( face );
+            switch ( actrelation ) {
+            case 0:
+                ++outside;
+                break;
+            case -1:
+                ++outbound;
+                break;
+            case 1:
+                ++inbound;
+                break;
+            default:
+                break;
+            }
         }
-        if( charID == '\n' ) {
-            if( intertext.mVertices.size() ) {
-                intertext.shift( Vector3D( -xpos * 0.5, ypos, 0 ));
-                text3D += intertext;
+        if( !inbound && !outbound ) {
+            char_polys.addContour( first_poly );
+            polygons.erase( polygons.begin() );
+        }
+        if( inbound && !outbound ) {
+            const int outer = char_polys.addContour( first_poly );
+            for( auto it = ++polygons.begin(); it != polygons.end(); ) {
+                int actrelation = first_poly.checkRelation( *it );
+                if( actrelation == 1 ) {
+                    char_polys.addContour( *it, outer );
+                    it = polygons.erase( it );
+                } else {
+                    ++it;
+                }
             }
-            intertext.clear();
-            xpos = 0;
-            ypos -= 3.0;
-            continue;
+            polygons.erase( polygons.begin() );
+        }
+        if( !inbound && outbound ) {
+            auto poly = std::move( first_poly );
+            polygons.erase( polygons.begin() );
+            polygons.push_back( std::move( poly ));
+        }
+        if( inbound && outbound ) {
+            std::cerr << "in and outbound in same contrext!\n";
+            polygons.erase( polygons.begin() );
         }
+    }
+    if( mergeOverlaps && overlapping( char_polys ))
+        char_polys = mergeContours( char_polys );
+    return char_polys;
+}
+
+Triangles VectorFont::extrudeGlyph( const PolygonSet &polys ) const {
+    return extrudeGlyph( polys, style );
+}
 
-        if( letters.find( charID ) == letters.end() ) // char not available
+Triangles VectorFont::extrudeGlyph( const PolygonSet &polys, const GlyphStyle &glyphStyle ) const {
+    Triangles mesh;
+    for( size_t i = 0; i < polys.contourCount(); ++i ) {
+        if( polys.parents[ i ] >= 0 )
             continue;
-        auto &kerning = kernings.at( charID );
-        xpos += kerning.getKerning( prevKerning, gap );
-        Triangles letter = letters.at( charID );
-        letter.shift( Vector3D( xpos, 0, 0 ));
-        intertext += letter;
-        xpos += kerning.getWidth();
-        prevKerning = &kerning;
+        Triangles part = TriangleGeneators::bevelExtrude( polys.face( i ), polys.holes( i ), glyphStyle.depth, glyphStyle.bevel, glyphStyle.roundStep, true, true );
+        BuildProfile::Timing timing( BuildProfile::Optimize );
+        mesh += part.optimized();
     }
-    if( intertext.mVertices.size() ) {
-        intertext.shift( Vector3D( -xpos * 0.5, ypos, 0 ));
-        text3D += intertext;
+    return mesh;
+}
+
+/* Straight walls between flat caps, the cheapest mesh of the same depth */
+
+VectorFont::GlyphStyle VectorFont::draftStyle() const {
+    GlyphStyle draft = style;
+    draft.bevel = 0;
+    draft.roundStep = 0;
+    return draft;
+}
+
+VectorFont::GlyphBuild VectorFont::buildGlyph( long charID, const PolygonSet &outlines, bool withMesh ) const {
+    GlyphBuild build;
+    build.report = GlyphReport();
+    BuildProfile::Scope scope( &build.report.stages );
+    Timer< std::chrono::nanoseconds > timer;
+    auto &char_polys = build.polys;
+    char_polys = groupContours( outlines );
+    build.report.groupMicros = timer.duration();
+    if( withMesh )
+        build.mesh = extrudeGlyph( char_polys );
+    timer.start();
+    build.kerning = glyphKerning( charID, char_polys, style.grow );
+    build.report.kerningMicros = timer.duration();
+    return build;
+}
+
+KerningSource VectorFont::glyphKerning( long charID, const PolygonSet &polys, float grow ) const {
+    KerningSource kerning( kerningAngles );
+    kerning.zerox.dy = minx;
+    for( size_t i = 0; i < polys.contourCount(); ++i ) {
+        if( polys.parents[ i ] >= 0 )
+            continue;
+        if( grow )
+            kerning.addFace( FaceGeneators::grow( polys.face( i ), grow ));
+        else
+            kerning.addFace( polys.face( i ));
     }
-    return text3D;
+    kerning.bBox = glyphs[ glyphIndex.find( charID ) ].box;
+    kerning.calc();
+    return kerning;
 }
 
-Triangles VectorFont::genTextPlane( string text )
-{
-    Faces holes;
-    Triangles textPlane;
-    Triangles intertext;
-    float xpos = 0;
-    float ypos = 0;
-    KerningSource *prevKerning = 0;
-    for( size_t chrpos = 0; chrpos < text.size(); ) {
-        unsigned long narrow = 0;
-        text.copy(( char* ) &narrow, 4, chrpos );
-        wchar_t charID = narrow & 0xff;
-        int utf8len = UTF8len( narrow );
-        switch( utf8len ) {
-        case 2:
-            charID = fromUTF8( narrow );
-            break;
-        case 3:
-            charID = fromUTF8( narrow );
-            break;
-        default:
+/* Packed forms keep the first byte of the sequence in the lowest byte */
+
+unsigned long VectorFont::fromUTF8( unsigned long narrow ) {
+    char bytes[ 4 ] = { char( narrow ), char( narrow >> 8 ), char( narrow >> 16 ), char( narrow >> 24 ) };
+    const char *pos = bytes;
+    return Utf8Decoder::next( pos, bytes + 4 );
+}
+
+unsigned long VectorFont::toUTF8( unsigned long wide ) {
+    unsigned char bytes[ 4 ];
+    int length = Utf8Decoder::encode( wide, ( char* ) bytes );
+    unsigned long narrow = 0;
+    for( int i = 0; i < length; ++i )
+        narrow |= ( unsigned long ) bytes[ i ] << ( 8 * i );
+    return narrow;
+}
+
+int VectorFont::UTF8len( unsigned long narrow ) {
+    char bytes[ 4 ] = { char( narrow ), char( narrow >> 8 ), char( narrow >> 16 ), char( narrow >> 24 ) };
+    const char *pos = bytes;
+    Utf8Decoder::next( pos, bytes + 4 );
+    return pos - bytes;
+}
+
+VectorFont::Layout VectorFont::layoutText( const string &text ) const {
+    Layout placements;
+    placements.reserve( text.size() );
+    std::vector< char32_t > codepoints;
+    Utf8Decoder::decode( text, codepoints );
+    layoutCodepoints( codepoints, placements );
+    return placements;
+}
+
+/* Appends the lines of a decoded text, the first one at line zero */
+
+void VectorFont::layoutCodepoints( const std::vector< char32_t > &codepoints, Layout &placements ) const {
+    const char32_t *lineBegin = codepoints.data();
+    const char32_t *end = lineBegin + codepoints.size();
+    int line = 0;
+    int previous = -1;
+    for( ;; ) {
+        const char32_t *lineEnd = std::find( lineBegin, end, U'\n' );
+        layoutLine( lineBegin, lineEnd, line, -3.0f * line, previous, placements );
+        if( lineEnd == end )
             break;
+        lineBegin = lineEnd + 1;
+        ++line;
+    }
+}
+
+/* Strings are laid out in blocks, one block per task into a buffer of its
+   own. The blocks are then copied to their final place in parallel */
+
+VectorFont::LayoutBatch VectorFont::layoutBatch( const std::vector< string > &texts, ThreadPool *pool ) const {
+    const size_t blockSize = 64;
+    const size_t blocks = ( texts.size() + blockSize - 1 ) / blockSize;
+    ThreadPool &threads = pool ? *pool : ThreadPool::global();
+    LayoutBatch batch;
+    batch.offsets.assign( texts.size() + 1, 0 );
+    std::vector< Layout > partial( blocks );
+    threads.parallelFor( blocks, [ this, &texts, &batch, &partial, blockSize ]( size_t block ) {
+        const size_t last = std::min( ( block + 1 ) * blockSize, texts.size() );
+        size_t bytes = 0;
+        for( size_t i = block * blockSize; i < last; ++i )
+            bytes += texts[ i ].size();
+        partial[ block ].reserve( bytes );
+        std::vector< char32_t > codepoints;
+        for( size_t i = block * blockSize; i < last; ++i ) {
+            const size_t before = partial[ block ].size();
+            codepoints.clear();
+            Utf8Decoder::decode( texts[ i ], codepoints );
+            layoutCodepoints( codepoints, partial[ block ] );
+            batch.offsets[ i + 1 ] = partial[ block ].size() - before;
         }
-        chrpos += utf8len;
-        holes.clear();
+    } );
+    for( size_t i = 0; i < texts.size(); ++i )
+        batch.offsets[ i + 1 ] += batch.offsets[ i ];
+    batch.placements.resize( batch.offsets.back() );
+    threads.parallelFor( blocks, [ &batch, &partial, blockSize ]( size_t block ) {
+        std::copy( partial[ block ].begin(), partial[ block ].end(), batch.placements.begin() + batch.offsets[ block * blockSize ] );
+    } );
+    return batch;
+}
+
+VectorFont::LineCursor::LineCursor() : offset( 0 ), line( 0 ), previous( -1 )
+{
+}
+
+/* Lays out the line at the cursor and steps past it, so a long text never
+   has to be laid out or decoded as a whole. Returns false after the last line */
+
+bool VectorFont::layoutNextLine( const string &text, LineCursor &cursor, Layout &placements ) const {
+    return layoutNextLine( text.data(), text.size(), cursor, placements );
+}
+
+/* The text may be a view into a mapped file, it is read up to size only */
+
+bool VectorFont::layoutNextLine( const char *text, size_t size, LineCursor &cursor, Layout &placements ) const {
+    if( cursor.offset > size )
+        return false;
+    const char *newline = cursor.offset < size ? static_cast< const char* >( memchr( text + cursor.offset, '\n', size - cursor.offset )) : nullptr;
+    const size_t end = newline ? newline - text : size;
+    std::vector< char32_t > codepoints;
+    Utf8Decoder decoder;
+    decoder.feed( text + cursor.offset, end - cursor.offset, codepoints );
+    decoder.finish( codepoints );
+    layoutLine( codepoints.data(), codepoints.data() + codepoints.size(), cursor.line, -3.0f * cursor.line, cursor.previous, placements );
+    cursor.offset = end + 1;
+    ++cursor.line;
+    return true;
+}
+
+/* Lays out a single line centered around zero. previous is the glyph before
+   the line, the kerning carries over spaces and line breaks */
+
+void VectorFont::layoutLine( const char32_t *begin, const char32_t *end, int line, float y, int &previous, Layout &placements ) const {
+    const size_t lineStart = placements.size();
+    float xpos = 0;
+    for( const char32_t *chr = begin; chr != end; ++chr ) {
+        const long charID = *chr;
         if( charID == ' ' ) {
             xpos += 0.8;
             continue;
         }
-        if( charID == '\n' ) {
-            if( intertext.mVertices.size() ) {
-                intertext.shift( Vector3D( -xpos * 0.5, ypos, 0 ));
-                textPlane += intertext;
-            }
-            intertext.clear();
-            xpos = 0;
-            ypos -= 3.0;
+        const int index = glyphIndex.find( charID );
+        if( index < 0 ) // char not available
             continue;
+        const Glyph &glyph = readyGlyph( index );
+        xpos += pairKerning( previous, index );
+        Placement placement = { charID, index, xpos, y, line };
+        placements.push_back( placement );
+        xpos += glyph.width;
+        previous = index;
+    }
+    for( size_t i = lineStart; i < placements.size(); ++i )
+        placements[ i ].x -= xpos * 0.5;
+}
+
+/* Layouts depend only on the text and the kerning, so recent ones are kept
+   and reused. With a layoutLimit of zero nothing is kept */
+
+VectorFont::LayoutPtr VectorFont::layout( const string &text ) {
+    {
+        std::unique_lock< std::mutex > lock( layoutMutex );
+        if( layoutGap != gap ) {
+            layouts.clear();
+            layoutGap = gap;
+        }
+        auto found = layouts.find( text );
+        if( found != layouts.end() ) {
+            found->second.used = ++layoutUses;
+            return found->second.placements;
+        }
+    }
+    LayoutPtr placements = std::make_shared< const Layout >( layoutText( text ));
+    std::unique_lock< std::mutex > lock( layoutMutex );
+    auto found = layouts.find( text );
+    if( found != layouts.end() )
+        return found->second.placements;
+    while( !layouts.empty() && layouts.size() >= layoutLimit ) {
+        auto oldest = layouts.begin();
+        for( auto it = layouts.begin(); it != layouts.end(); ++it ) {
+            if( it->second.used < oldest->second.used )
+                oldest = it;
         }
+        layouts.erase( oldest );
+    }
+    if( layoutLimit ) {
+        CachedLayout cached = { placements, ++layoutUses };
+        layouts.insert( std::make_pair( text, cached ));
+    }
+    return placements;
+}
 
-        if( letters.find( charID ) == letters.end() ) // char not available
-            continue;
-        auto &kerning = kernings.at( charID );
-        xpos += kerning.getKerning( prevKerning, gap );
-        Triangles letter = letters.at( charID );
-        letter.shift( Vector3D( xpos, 0, 0 ));
-        intertext += letter;
-        xpos += kerning.getWidth();
-        prevKerning = &kerning;
-    }
-    if( intertext.mVertices.size() ) {
-        intertext.shift( Vector3D( -xpos * 0.5, ypos, 0 ));
-        textPlane += intertext;
-    }
-    return textPlane;
+void VectorFont::clearLayouts() {
+    std::unique_lock< std::mutex > lock( layoutMutex );
+    layouts.clear();
+}
+
+/* Totals are known from the layout, so the mesh is sized once and every
+   glyph is written straight to its final place with its offset applied.
+   Lines own disjoint ranges and are filled in parallel for large texts.
+   The mesh of every glyph is read once, a refinement cannot swap it between
+   the passes */
+
+Triangles VectorFont::buildMesh( const Layout &placements ) const {
+    const size_t count = placements.size();
+    std::vector< size_t > firstVertex( count + 1, 0 );
+    std::vector< size_t > firstIndex( count + 1, 0 );
+    std::vector< size_t > lineStarts;
+    std::vector< GlyphMesh > meshes( glyphs.size() );
+    for( size_t i = 0; i < count; ++i ) {
+        GlyphMesh &mesh = meshes[ placements[ i ].glyph ];
+        if( !mesh )
+            mesh = glyphMesh( placements[ i ].glyph );
+        const Triangles &glyph = *mesh;
+        firstVertex[ i + 1 ] = firstVertex[ i ] + glyph.mVertices.size();
+        firstIndex[ i + 1 ] = firstIndex[ i ] + glyph.mIndices.size();
+        if( !i || placements[ i ].line != placements[ i - 1 ].line )
+            lineStarts.push_back( i );
+    }
+    lineStarts.push_back( count );
+    Triangles mesh;
+    mesh.mVertices.resize( firstVertex[ count ] );
+    mesh.mNormals.resize( firstVertex[ count ] );
+    mesh.mIndices.resize( firstIndex[ count ] );
+    auto emitLine = [ &placements, &meshes, &firstVertex, &firstIndex, &lineStarts, &mesh ]( size_t line ) {
+        for( size_t i = lineStarts[ line ]; i < lineStarts[ line + 1 ]; ++i ) {
+            const Triangles &glyph = *meshes[ placements[ i ].glyph ];
+            const Vector3D shift( placements[ i ].x, placements[ i ].y, 0 );
+            Vector3D *vertex = mesh.mVertices.data() + firstVertex[ i ];
+            for( const auto &source : glyph.mVertices )
+                *vertex++ = source + shift;
+            std::copy( glyph.mNormals.begin(), glyph.mNormals.end(), mesh.mNormals.begin() + firstVertex[ i ] );
+            const uint base = firstVertex[ i ];
+            uint *index = mesh.mIndices.data() + firstIndex[ i ];
+            for( auto source : glyph.mIndices )
+                *index++ = base + source;
+        }
+    };
+    const size_t lines = lineStarts.size() - 1;
+    if( firstVertex[ count ] >= parallelMeshVertices )
+        ThreadPool::global().parallelFor( lines, emitLine );
+    else
+        for( size_t line = 0; line < lines; ++line )
+            emitLine( line );
+    return mesh;
+}
+
+VectorFont::Text3D VectorFont::placeChars( const Layout &placements ) const {
+    Text3D chars3D;
+    chars3D.reserve( placements.size() );
+    for( const auto &placement : placements ) {
+        Char3D letter;
+        letter.geometry = glyphMesh( placement.glyph );
+        letter.pos = Vector3D( placement.x, placement.y, 0 );
+        letter.charID = placement.charID;
+        letter.line = placement.line;
+        chars3D.push_back( letter );
+    }
+    return chars3D;
+}
+
+VectorFont::Text3D VectorFont::genTextChars( const string &text ) {
+    return placeChars( *layout( text ));
+}
+
+Triangles VectorFont::genText( const string &text ) {
+    return buildMesh( *layout( text ));
+}
+
+Triangles VectorFont::genTextPlane( const string &text ) {
+    return buildMesh( *layout( text ));
 }
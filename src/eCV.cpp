@@ -1,13 +1,73 @@
 #include "eCV.h"
 #include <math.h>
+#include <limits>
 #include "Roboto_Regular.h"
 #include "Intro.h"
+#include "Utf8.h"
+#include <algorithm>
 
 using namespace std;
 
 const char *ApplicationClassName = "eCV";
 const char *ApplicationName = "Electoric Introduction";
 
+/* Seconds before landing a streamed line is laid out. Letters further out
+   in time fly beyond the far plane. Lines also stay this far above the view */
+
+const float streamLookahead = 8.0f;
+const float streamMargin = 4.0f;
+
+/* Bytes of glyph meshes kept for a text streamed in a TrueType font */
+
+const size_t streamMeshBudget = 32 << 20;
+
+/* Keys listed at the top of the screen while the status is shown */
+
+const char *hudHelp = "H status  D F depth  B V bevel  R round  W wire  T transparent  P pause";
+
+/* Characters always loaded from a TrueType font, the set fontParser writes */
+
+const char *fontCharacters = "ABCDEFGHIJKLMNOPQRSTUVWXYZÖÜÓŐÚÉÁŰÍabcdefghijklmnopqrstuvwxyzöüópőúéáűí0123456789\\\"_-+/*?!%/=()&,.:$€<>[]{}°^~";
+
+/* Curves of a TrueType font are flattened for the largest size the text
+   takes on screen, seen from this distance in the scrolling view. An em
+   is 2.048 units. The font stays open and is flattened again when the
+   window height calls for twice or half the detail */
+
+const float nearestText = 12.0f;
+const float textFieldOfView = 40.0f;
+
+static float textTolerance( int height )
+{
+    const float pixelsPerEm = 2.048f * height / ( 2 * nearestText * tanf( textFieldOfView * float( M_PI ) / 360 ));
+    return TrueTypeFont::toleranceFor( pixelsPerEm );
+}
+
+/* Collects the distinct characters of a mapped text a chunk at a time, a
+   long text is never held decoded as a whole */
+
+static void decodeDistinct( const char *text, size_t size, std::vector< char32_t > &chars )
+{
+    const size_t chunk = 1 << 20;
+    Utf8Decoder decoder;
+    for( size_t offset = 0; offset < size; offset += chunk ) {
+        decoder.feed( text + offset, std::min( chunk, size - offset ), chars );
+        std::sort( chars.begin(), chars.end() );
+        chars.erase( std::unique( chars.begin(), chars.end() ), chars.end() );
+    }
+    decoder.finish( chars );
+}
+
+/* Color of the letters, the picked one and the status line are lit up */
+
+const float letterColor[ 3 ] = { 0.392f, 0.431f, 0.550f };
+const float highlightColor[ 3 ] = { 0.784f, 0.863f, 0.980f };
+
+static void setColor( Program &program, const char *name, const float *color, float alpha )
+{
+    program.setUniform( name, color[ 0 ], color[ 1 ], color[ 2 ], alpha );
+}
+
 const char *vertexShaderSource =
     "#version 330\n"
     "attribute lowp vec4 posAttr;\n"
@@ -46,6 +106,32 @@ const char *fragmentShaderSource =
     "   gl_FragColor.a = color.a;\n"
     "}\n";
 
+/* Flat text from the distance field atlas, the outline is at 128 */
+
+const char *sdfVertexShaderSource =
+    "#version 330\n"
+    "attribute lowp vec4 posAttr;\n"
+    "attribute lowp vec2 texAttr;\n"
+    "varying lowp vec2 tex;\n"
+    "uniform lowp mat4 projection;\n"
+    "uniform lowp mat4 model;\n"
+    "void main() {\n"
+    "   tex = texAttr;\n"
+    "   gl_Position = projection * model * posAttr;\n"
+    "}\n";
+
+const char *sdfFragmentShaderSource =
+    "#version 330\n"
+    "uniform sampler2D atlas;\n"
+    "uniform lowp vec4 color;\n"
+    "varying lowp vec2 tex;\n"
+    "void main() {\n"
+    "   float distance = texture2D( atlas, tex ).r;\n"
+    "   float width = fwidth( distance );\n"
+    "   gl_FragColor = color;\n"
+    "   gl_FragColor.a = color.a * smoothstep( 0.502 - width, 0.502 + width, distance );\n"
+    "}\n";
+
 const char *minimalFragmentShaderSource =
         "#version 330\n"
         "uniform lowp vec4 color;\n"
@@ -53,7 +139,7 @@ const char *minimalFragmentShaderSource =
         "   gl_FragColor = color;\n"
         "}\n";
 
-singleChar::singleChar( std::shared_ptr<VectorFont::Char3D> letter  ) {
+singleChar::singleChar( const VectorFont::Char3D &letter ) {
     this->letter = letter;
     rotate_y = 0;
     rotate_z = 0;
@@ -85,35 +171,105 @@ Letters3D::Letters3D( const VectorFont::Text3D &text )
 
 Letters3D *Letters3D::operator =( const VectorFont::Text3D &text )
 {
-   singleChar chr;
-   chr.rotate_y = 0;
-   for( auto letter : text ) {
+   letters.reserve( letters.size() + text.size() );
+   for( const auto &letter : text ) {
        letters.push_back( singleChar( letter ));
    }
    return this;
 }
 
-void Letters3D::randomize()
+void Letters3D::randomize( size_t first )
 {
     float speed = 0;
     float ypos = 0;
-    for( auto &letter : letters ) {
+    for( auto it = letters.begin() + first; it != letters.end(); ++it ) {
+        auto &letter = *it;
         letter.rotate_y = 0;
         letter.rotate_z = 0;
-        letter.move_from.x = letter.letter->pos.x + get_rnd( -8000, 8000 ) * 1e-3f;
-        letter.move_from.y = letter.letter->pos.y + get_rnd( 1000, 4000 ) * 1e-3f;
-        letter.move_from.z = letter.letter->pos.z + get_rnd( -6000, -10000 ) * 1e-3f;
+        letter.move_from.x = letter.letter.pos.x + get_rnd( -8000, 8000 ) * 1e-3f;
+        letter.move_from.y = letter.letter.pos.y + get_rnd( 1000, 4000 ) * 1e-3f;
+        letter.move_from.z = letter.letter.pos.z + get_rnd( -6000, -10000 ) * 1e-3f;
         letter.rotate_y = get_rnd( 300, -300 );
         letter.rotate_z = get_rnd( -200, 200 );
-        letter.time = -letter.letter->pos.y * 0.5 + get_rnd( 1000, 3000 ) * 1e-3f;
-        if( !speed || ypos != letter.letter->pos.y ) {
+        letter.time = -letter.letter.pos.y * 0.5 + get_rnd( 1000, 3000 ) * 1e-3f;
+        if( !speed || ypos != letter.letter.pos.y ) {
             speed = get_rnd( 800, 3000 ) * 1e-3f;
-            ypos = letter.letter->pos.y;
+            ypos = letter.letter.pos.y;
         }
         letter.speed = speed;
     }
 }
 
+void Letters3D::retire( size_t count )
+{
+    letters.erase( letters.begin(), letters.begin() + count );
+    bvh.retire( count );
+}
+
+/* Transform of the letter in the flight, the scrolling of the text is not included */
+
+Matrix singleChar::placement( float difftime, float angle ) const
+{
+    float curtime = std::max( 0.0f, time - difftime );
+    Vector3D pos( letter.pos.x + ( move_from.x - letter.pos.x ) * curtime,
+                  letter.pos.y + ( move_from.y - letter.pos.y ) * curtime,
+                  letter.pos.z + ( move_from.z - letter.pos.z ) * curtime );
+    Matrix transform;
+    transform.translate( pos + Vector3D( 0, 0, 0.3 * sin( speed * angle + letter.pos.x * 0.6 )));
+    transform.rotate( rotate_y * curtime, 0, 1, 0 );
+    transform.rotate( rotate_z * curtime, 0, 0, 1 );
+    return transform;
+}
+
+void Letters3D::buildBVH( VectorFont &font )
+{
+    bvh.clear();
+    for( const auto &letter : letters ) {
+        Matrix transform;
+        transform.translate( letter.letter.pos );
+        bvh.addInstance( &font.glyphBVH( letter.letter.charID ), transform );
+    }
+    bvh.build( &ThreadPool::global() );
+}
+
+/* Adds the letters appended since the last call, the tree is only built
+   again once enough of it changed */
+
+void Letters3D::extendBVH( VectorFont &font )
+{
+    for( size_t i = bvh.size(); i < letters.size(); ++i ) {
+        Matrix transform;
+        transform.translate( letters[ i ].letter.pos );
+        bvh.addInstance( &font.glyphBVH( letters[ i ].letter.charID ), transform );
+    }
+    bvh.update( &ThreadPool::global() );
+}
+
+/* Moves the instances to the current frame. The tree built over the resting
+   positions is only refitted, it gets looser while the letters are flying */
+
+void Letters3D::place( float difftime, float angle )
+{
+    for( size_t i = 0; i < letters.size(); ++i )
+        bvh.place( i, letters[ i ].placement( difftime, angle ));
+    bvh.refit();
+}
+
+/* Takes the current meshes of the font, refined ones replace the drafts */
+
+void Letters3D::refresh( const VectorFont &font )
+{
+    for( auto &letter : letters )
+        letter.letter.geometry = font.glyphMesh( font.glyphIndex.find( letter.letter.charID ));
+}
+
+int Letters3D::pick( const Ray &ray, RayHit &hit ) const
+{
+    if( !bvh.intersect( ray, hit ))
+        return -1;
+    return hit.instance;
+}
+
 AnimHandler::AnimHandler( ANIMTYPE animType ) {
     this->animType = animType;
     this->scaleFactor = Vector2D( 1, 1 );
@@ -212,7 +368,7 @@ bool AnimHandler::isRunning() {
     return running;
 }
 
-ECV::ECV()
+ECV::ECV() : mHud( false ), mAtlasTexture( 0 ), mHudText( defaultFont, "\n" ), mPicked( -1 ), mText( Intro ), mStreaming( false ), mMaxLetters( 20000 ), mRefined( 0 ), mTolerance( 0 )
 {
 
 }
@@ -221,10 +377,58 @@ void ECV::Init()
 {
     createWindow();
 
-    defaultFont.Init( Roboto_Regular::font, 0.1f, 0.5f, 0.12f, 1 );
+    /* Glyphs of the intro are built as it is laid out, the refiner builds
+       the rest and stores the cache, which a later start loads instead */
+
+    defaultFont.lazy = true;
+    defaultFont.progressive = true;
+    defaultFont.profileBuild = !mBuildReport.empty();
+    defaultFont.cachePath = "eCV.glyphcache";
+
+    /* A TrueType font given on the command line is mapped, only the glyphs
+       of the text and of the built-in character set are decoded. With a
+       streamed text their meshes are left to the glyph cache */
+
+    if( !mFontPath.empty() && !mTrueType.open( mFontPath.c_str() ))
+        log_message( "Could not open font %s\n", mFontPath.c_str() );
+    if( mTrueType.isOpen() ) {
+        Utf8Decoder::decode( fontCharacters, mFontChars );
+        if( mStreaming )
+            decodeDistinct(( const char* ) mTextFile.data, mTextFile.size, mFontChars );
+        else
+            Utf8Decoder::decode( mText, mFontChars );
+        std::sort( mFontChars.begin(), mFontChars.end() );
+        mFontChars.erase( std::unique( mFontChars.begin(), mFontChars.end() ), mFontChars.end() );
+        mTolerance = mTrueType.tolerance = textTolerance( winh );
+        defaultFont.keepMeshes = !mStreaming;
+        defaultFont.Init( mTrueType.source( mFontChars ), 0.1f, 0.5f, 0.12f, 1 );
+    } else {
+        defaultFont.Init( Roboto_Regular::font(), 0.1f, 0.5f, 0.12f, 1 );
+    }
+    if( !defaultFont.keepMeshes ) {
+        mGlyphCache.setBudget( streamMeshBudget );
+        mGlyphCache.addFont( defaultFont );
+    }
+    if( mStreaming )
+        defaultFont.warm( string(( const char* ) mTextFile.data, Utf8Decoder::boundary(( const char* ) mTextFile.data, mTextFile.size, 4096 )));
+    else
+        defaultFont.warm( mText );
 
     program.CompileShaders( vertexShaderSource, fragmentShaderSource );
     minimalProgram.CompileShaders( vertexShaderSource, minimalFragmentShaderSource );
+    sdfProgram.CompileShaders( sdfVertexShaderSource, sdfFragmentShaderSource );
+
+    mAtlas.build( defaultFont );
+    mHelp = mAtlas.genText( defaultFont.layoutText( hudHelp ));
+    mStyle = defaultFont.style;
+    glGenTextures( 1, &mAtlasTexture );
+    glBindTexture( GL_TEXTURE_2D, mAtlasTexture );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+    glTexImage2D( GL_TEXTURE_2D, 0, GL_R8, mAtlas.width, mAtlas.height, 0, GL_RED, GL_UNSIGNED_BYTE, mAtlas.pixels.data() );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
     glHint( GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST );
 
     glShadeModel( GL_SMOOTH );
@@ -258,8 +462,13 @@ void ECV::Init()
     cursor.push_back( Vector2D(  0.00f, -0.03f ));
     mCursor = TriangleGeneators::bevelExtrude( cursor, 0.02, 0.005, 1, true, true );
 
-    mChars = std::make_shared<Letters3D>( defaultFont.genTextChars( Intro ));
-    mChars->randomize();
+    if( mStreaming ) {
+        mChars = std::make_shared<Letters3D>( VectorFont::Text3D() );
+    } else {
+        mChars = std::make_shared<Letters3D>( defaultFont.genTextChars( mText ));
+        mChars->randomize();
+        mChars->buildBVH( defaultFont );
+    }
 
     mChars->start_time = clock.duration();
 }
@@ -268,8 +477,21 @@ void ECV::HandleEvents()
 {
 }
 
+/* The build report is written once the refined meshes are done, glyphs
+   read from the cache show no build time. The refiner is then stopped
+   here, while the thread pool it runs on still exists */
+
 void ECV::Finish()
 {
+    if( !mBuildReport.empty() ) {
+        defaultFont.waitRefined();
+        defaultFont.logBuildReport();
+        if( !defaultFont.saveBuildReport( mBuildReport ))
+            log_message( "Could not write build report %s\n", mBuildReport.c_str() );
+    }
+    defaultFont.cancelRefining();
+    if( !defaultFont.keepMeshes )
+        mGlyphCache.report();
 }
 
 void ECV::keyPress( char key )
@@ -296,6 +518,24 @@ void ECV::keyPress( char key )
     case 'P':
         mPause = !mPause;
         break;
+    case 'H':
+        mHud = !mHud;
+        break;
+    case 'D':
+        restyleFont( 0.1f, 0, 0 );
+        break;
+    case 'F':
+        restyleFont( -0.1f, 0, 0 );
+        break;
+    case 'B':
+        restyleFont( 0, 0.02f, 0 );
+        break;
+    case 'V':
+        restyleFont( 0, -0.02f, 0 );
+        break;
+    case 'R':
+        restyleFont( 0, 0, 1 );
+        break;
     }
 }
 
@@ -329,6 +569,90 @@ void ECV::mouseRelease()
 
 }
 
+/* Drops the lines that scrolled above the view and lays out the ones about
+   to fly in. A line lands about half a second later per unit of depth, see
+   Letters3D::randomize. The live letters never exceed mMaxLetters */
+
+void ECV::streamLines( float difftime, float top )
+{
+    auto &letters = mChars->letters;
+    size_t retired = 0;
+    while( retired < letters.size() && letters[ retired ].letter.pos.y > top )
+        ++retired;
+    bool changed = retired > 0;
+    mChars->retire( retired );
+    VectorFont::Layout placements;
+    while( letters.size() < mMaxLetters && 1.5f * mLines.line + 1.0f - difftime < streamLookahead ) {
+        placements.clear();
+        if( !defaultFont.layoutNextLine(( const char* ) mTextFile.data, mTextFile.size, mLines, placements ))
+            break;
+        const size_t first = letters.size();
+        *mChars = defaultFont.placeChars( placements );
+        mChars->randomize( first );
+        changed = true;
+    }
+    if( changed )
+        mChars->extendBVH( defaultFont );
+}
+
+/* Between frames the letters move over to a finished restyle and to
+   refined meshes as they become ready. Small boards then keep only what
+   layout and drawing need */
+
+void ECV::refreshGlyphs()
+{
+    adaptDetail();
+    if( defaultFont.applyRestyle() )
+        mChars->refresh( defaultFont );
+#if RPI4
+    if( defaultFont.isRefined() && !defaultFont.frozen ) {
+        defaultFont.compact();
+        mChars->refresh( defaultFont );
+    }
+#endif
+    const size_t refined = defaultFont.refinedGlyphs;
+    if( refined == mRefined )
+        return;
+    mRefined = refined;
+    mChars->refresh( defaultFont );
+    defaultFont.updatePicking();
+}
+
+/* The glyphs are decoded again and their meshes come in like a restyle,
+   all on the refiner thread. The built-in font has no curves left to
+   flatten, and a font whose meshes the cache keeps can not be rebuilt */
+
+void ECV::adaptDetail()
+{
+    if( !mTrueType.isOpen() || !defaultFont.keepMeshes )
+        return;
+    const float tolerance = textTolerance( winh );
+    if( tolerance > 0.5f * mTolerance && tolerance < 2 * mTolerance )
+        return;
+    mTolerance = tolerance;
+    const bool started = defaultFont.reflatten( [ this, tolerance ]() {
+        mTrueType.tolerance = tolerance;
+        return mTrueType.source( mFontChars );
+    } );
+    if( !started )
+        log_message( "The font can not be flattened again\n" );
+}
+
+/* Depth and bevel step up and down, the rounding cycles from one to four
+   steps. The grow stays, it would move the letters */
+
+void ECV::restyleFont( float depthStep, float bevelStep, int roundSteps )
+{
+    VectorFont::GlyphStyle next = mStyle;
+    next.depth = std::max( 0.1f, next.depth + depthStep );
+    next.bevel = std::min( std::max( 0.0f, next.bevel + bevelStep ), 0.45f * next.depth );
+    next.roundStep = ( next.roundStep + roundSteps - 1 ) % 4 + 1;
+    if( defaultFont.restyle( next ))
+        mStyle = next;
+    else
+        log_message( "The font can not be restyled\n" );
+}
+
 void ECV::paint()
 {
     glViewport( 0, 0, winw, winh );
@@ -403,8 +727,8 @@ void ECV::paint()
     } else {
         curProgram.setUniform( "lightPos", 0, -40, -40, 0 );
         curProgram.setUniform( "ambient", 0.2f );
-        curProgram.setUniform( "color", 0.392f, 0.431f, 0.550f, 0.292f );
-        curProgram.setUniform( "specColor", 0.784f, 0.863f, 0.980f, 1.f );
+        setColor( curProgram, "color", letterColor, 0.292f );
+        setColor( curProgram, "specColor", highlightColor, 1.f );
     }
 
     projection.toIdent();
@@ -435,39 +759,106 @@ void ECV::paint()
     glDisable( GL_BLEND );
     glEnable( GL_DEPTH_TEST );
     glEnable( GL_CULL_FACE );
-    curProgram.setUniform( "color", 0.392f, 0.431f, 0.550f, 1.f );
+    setColor( curProgram, "color", letterColor, 1.f );
 
     curProgram.setUniform( "lightPos", 3, -8, -65, 0 );
-    projection.perspective( 40.0f, 1.0f * winw / winh, 0.1f, 100.0f );
+    projection.perspective( textFieldOfView, 1.0f * winw / winh, 0.1f, 100.0f );
     curProgram.setUniform( "projection", projection );
     view.toIdent();
     view.rotate( -45, 1, 0, 0 );
     curProgram.setUniform( "view", view );
+    /* The scrolling is moved into the picking ray, the instances follow the flight of the letters */
+    Matrix scroll;
+    scroll.translate( 0, 10.2 + 2 * angle, -26 );
+    const Matrix unproject = ( scroll * view * projection ).inverted();
     float difftime = angle - mChars->start_time;
+    if( mStreaming ) {
+        /* Top of the view on the plane of the resting letters */
+        Ray topRay = Ray::fromScreen( unproject, 0, 1 );
+        float top = topRay.direction.z < 0 ? topRay.at( -topRay.origin.z / topRay.direction.z ).y : std::numeric_limits< float >::max();
+        streamLines( difftime, top + streamMargin );
+    }
+    refreshGlyphs();
+    mChars->place( difftime, angle );
+    RayHit hit;
+    mPicked = mChars->pick( Ray::fromScreen( unproject, xPos / ow, yPos ), hit );
     float mintime = -5;
-    for( auto letter : mChars->letters ) {
-        model.toIdent();
+    int index = 0;
+    for( const auto &letter : mChars->letters ) {
         float curtime = letter.time - difftime;
         if( mintime < curtime )
             mintime = curtime;
-        if( curtime < 0 )
-            curtime = 0;
-        Vector3D pos( letter.letter->pos.x + ( letter.move_from.x - letter.letter->pos.x ) * curtime,
-                      letter.letter->pos.y + ( letter.move_from.y - letter.letter->pos.y ) * curtime,
-                      letter.letter->pos.z + ( letter.move_from.z - letter.letter->pos.z ) * curtime );
-        model.translate( 0, 10.2 + 2 * angle, -26 );
-        model.translate( pos + Vector3D( 0, 0, 0.3 * sin( letter.speed * angle + letter.letter->pos.x * 0.6 )));
-        model.rotate( letter.rotate_y * curtime, 0, 1, 0 );
-        model.rotate( letter.rotate_z * curtime, 0, 0, 1 );
+        model = letter.placement( difftime, angle ) * scroll;
         curProgram.setUniform( "model", model );
-        curProgram.drawMesh( letter.letter->geometry );
+        if( index == mPicked && !mWire )
+            setColor( curProgram, "color", highlightColor, 1.f );
+        curProgram.drawMesh( *letter.letter.geometry );
+        if( index++ == mPicked && !mWire )
+            setColor( curProgram, "color", letterColor, 1.f );
     }
     curProgram.enablePosition( false );
     curProgram.enableNormal( false );
+
+    if( mHud )
+        paintHud( ow );
     std::this_thread::sleep_for( std::chrono::milliseconds( 2 ));
     curProgram.resetProgream();
 }
 
+/* Only a status line whose text changed is laid out and meshed again, or one
+   whose glyph meshes the font replaced since */
+
+void ECV::paintHud( float ow )
+{
+    char status[ 64 ];
+    snprintf( status, sizeof( status ), "%zu letters", mChars->letters.size() );
+    mHudText.setLine( 0, status );
+    snprintf( status, sizeof( status ), "depth %.1f, bevel %.2f, round %d", defaultFont.style.depth, defaultFont.style.bevel, defaultFont.style.roundStep );
+    mHudText.setLine( 1, status );
+    mHudText.update();
+
+    Matrix projection;
+    Matrix view;
+    Matrix model;
+    projection.ortho( -1, 1, -ow, ow, -1, 1 );
+    glDisable( GL_DEPTH_TEST );
+    glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
+
+    program.useProgram();
+    program.enablePosition();
+    program.enableNormal();
+    program.setUniform( "projection", projection );
+    program.setUniform( "view", view );
+    model.translate( 0, -0.8f, 0 );
+    model.scale( 0.04f );
+    program.setUniform( "model", model );
+    program.setUniform( "lightPos", 0, 0, -10, 0 );
+    program.setUniform( "ambient", 0.6f );
+    setColor( program, "color", highlightColor, 1.f );
+    glDisable( GL_BLEND );
+    glEnable( GL_CULL_FACE );
+    program.drawMesh( mHudText.mesh );
+    program.enablePosition( false );
+    program.enableNormal( false );
+
+    sdfProgram.useProgram();
+    sdfProgram.enablePosition();
+    sdfProgram.enableTexCoord();
+    sdfProgram.setUniform( "projection", projection );
+    model.toIdent();
+    model.translate( 0, 0.95f, 0 );
+    model.scale( 0.03f );
+    sdfProgram.setUniform( "model", model );
+    setColor( sdfProgram, "color", highlightColor, 1.f );
+    glDisable( GL_CULL_FACE );
+    glEnable( GL_BLEND );
+    glBindTexture( GL_TEXTURE_2D, mAtlasTexture );
+    sdfProgram.drawMesh( mHelp );
+    sdfProgram.enablePosition( false );
+    sdfProgram.enableTexCoord( false );
+    glBindTexture( GL_TEXTURE_2D, texId );
+}
+
 ECV mainWindow;
 
 void exitApp() {
@@ -476,8 +867,37 @@ void exitApp() {
 
 int main( int argc, char* argv[] )
 {
+    /* The shared thread pool is made before exitApp is registered, so it is
+       destroyed only after exitApp has run */
+
+    ThreadPool::global();
     atexit( exitApp );
-    (void) argc, (void) argv;
+
+    /* A text file given on the command line is streamed line by line.
+       --font takes a TrueType font and --report a glyph build report, CSV or
+       JSON by its extension. Each can be given without the others */
+
+    const char *textPath = nullptr;
+    for( int i = 1; i < argc; ++i ) {
+        const string arg = argv[ i ];
+        if( arg == "--font" && i + 1 < argc ) {
+            mainWindow.mFontPath = argv[ ++i ];
+        } else if( arg == "--report" && i + 1 < argc ) {
+            mainWindow.mBuildReport = argv[ ++i ];
+        } else if( arg.compare( 0, 2, "--" ) && !textPath ) {
+            textPath = argv[ i ];
+        } else {
+            log_message( "Usage: %s [text file] [--font font.ttf] [--report report.csv]\n", argv[ 0 ] );
+            return 1;
+        }
+    }
+    if( textPath ) {
+        if( mainWindow.mTextFile.open( textPath )) {
+            mainWindow.mStreaming = true;
+        } else {
+            log_message( "Could not open %s\n", textPath );
+        }
+    }
 
     mainWindow.Run();
 
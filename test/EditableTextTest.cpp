@@ -0,0 +1,61 @@
+#include "EditableText.h"
+#include "Roboto_Regular.h"
+#include <cstdio>
+
+/* Edits one line of a three line text and checks that only the slot of that
+   line is laid out, meshed and patched, then that a restyle of the font
+   rebuilds every line from the new meshes */
+
+static int failures = 0;
+
+static void check( bool condition, const char *what )
+{
+    if( !condition ) {
+        printf( "FAILED: %s\n", what );
+        ++failures;
+    }
+}
+
+int main()
+{
+    VectorFont font;
+    font.Init( Roboto_Regular::font(), 0.1f, 0.5f, 0.12f, 1 );
+    EditableText text( font, "first line\nsecond line\nthird line" );
+    check( text.update() == 3, "every line is built at first" );
+    check( text.update() == 0, "nothing is built without an edit" );
+
+    const std::vector< Vector3D > before = text.mesh.mVertices;
+    const EditableText::Line first = text.lines[ 0 ];
+    const EditableText::Line third = text.lines[ 2 ];
+    text.setLine( 1, "second lime" );
+    check( text.update() == 1, "only the edited line is built" );
+    check( text.vertexPatches.size() == 1 && text.vertexPatches[ 0 ].first == text.lines[ 1 ].firstVertex,
+           "only the slot of the edited line is patched" );
+    check( text.lines[ 0 ].firstVertex == first.firstVertex && text.lines[ 2 ].firstVertex == third.firstVertex,
+           "the other lines keep their slots" );
+    bool untouched = true;
+    for( const EditableText::Line *line : { &first, &third } ) {
+        for( size_t i = line->firstVertex; i < line->firstVertex + line->vertexCount; ++i ) {
+            const Vector3D &now = text.mesh.mVertices[ i ];
+            untouched = untouched && now.x == before[ i ].x && now.y == before[ i ].y && now.z == before[ i ].z;
+        }
+    }
+    check( untouched, "the vertices of the other lines stay" );
+
+    VectorFont::GlyphStyle deeper = font.style;
+    deeper.depth = 0.8f;
+    check( font.restyle( deeper ), "the font restyles" );
+    font.waitRefined();
+    check( font.applyRestyle(), "the restyle is applied" );
+    check( text.update() == 3, "every line is built from the restyled meshes" );
+    bool restyled = true;
+    for( const auto &line : text.lines ) {
+        for( size_t i = 0; i < line.placements.size(); ++i )
+            restyled = restyled && line.meshes[ i ] == font.glyphMesh( line.placements[ i ].glyph );
+    }
+    check( restyled, "the lines hold the restyled meshes" );
+
+    if( !failures )
+        printf( "EditableText: all checks passed\n" );
+    return failures;
+}
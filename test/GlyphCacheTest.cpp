@@ -0,0 +1,53 @@
+#include "GlyphCache.h"
+#include "Roboto_Regular.h"
+#include <cstdio>
+
+/* Fetches every glyph of a font through a cache whose budget holds only a
+   few meshes, and checks the hit, miss and eviction counters, the budget and
+   that a mesh still held is taken back instead of extruded again */
+
+static int failures = 0;
+
+static void check( bool condition, const char *what )
+{
+    if( !condition ) {
+        printf( "FAILED: %s\n", what );
+        ++failures;
+    }
+}
+
+int main()
+{
+    GlyphCache cache;
+    const int font = cache.addFont( Roboto_Regular::font(), 0.1f, 0.5f, 0.12f, 1 );
+    const int count = cache.font( font ).glyphs.size();
+    check( cache.font( font ).kerningTable.empty(), "adding a font builds no kerning table" );
+
+    const VectorFont::GlyphMesh first = cache.mesh( font, 0 );
+    const size_t budget = 4 * ( sizeof( Triangles ) + first->mVertices.size() * 2 * sizeof( Vector3D ) + first->mIndices.size() * sizeof( uint ));
+    cache.setBudget( budget );
+    for( int glyph = 1; glyph < count; ++glyph )
+        cache.mesh( font, glyph );
+    GlyphCache::Counters counters = cache.counters();
+    check( counters.misses == size_t( count ), "every first fetch misses" );
+    check( counters.hits == 0, "nothing hits before a repeat" );
+    check( counters.evictions > 0, "meshes are evicted over the budget" );
+    check( counters.bytes <= budget, "the kept meshes stay within the budget" );
+    check( counters.meshes + counters.evictions == size_t( count ), "every mesh is either kept or evicted" );
+
+    cache.mesh( font, count - 1 );
+    check( cache.counters().hits == 1, "the most recent mesh hits" );
+    const size_t evictions = cache.counters().evictions;
+    check( cache.mesh( font, 0 ) == first, "an evicted mesh still held is taken back" );
+    check( cache.counters().misses == size_t( count ) + 1, "taking a mesh back counts as a miss" );
+    check( cache.counters().evictions >= evictions, "taking a mesh back may evict others" );
+
+    VectorFont &cached = cache.font( font );
+    const long charID = cached.glyphs[ 1 ].charID;
+    check( !cached.glyphBVH( charID ).tree.nodes.empty(), "a cached font builds picking from cached meshes" );
+    check( !cached.buildMesh( cached.layoutText( "Glyph cache" )).mVertices.empty(), "a cached font meshes text through the cache" );
+
+    if( !failures )
+        printf( "GlyphCache: all checks passed\n" );
+    return failures;
+}